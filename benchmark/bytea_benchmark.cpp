@@ -0,0 +1,103 @@
+/*
+ * bytea_benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <tip/db/pg/common.hpp>
+#include <tip/db/pg/protocol_io_traits.hpp>
+#include <tip/db/pg/detail/protocol_parsers.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace tip::db::pg;
+
+std::vector< char >
+make_hex(size_t n)
+{
+	char const* digits = "0123456789abcdef";
+	std::vector< char > hex{ '\\', 'x' };
+	hex.reserve(n * 2 + 2);
+	for (size_t i = 0; i < n; ++i) {
+		unsigned char c = static_cast<unsigned char>(i * 31);
+		hex.push_back(digits[c >> 4]);
+		hex.push_back(digits[c & 0xf]);
+	}
+	return hex;
+}
+
+std::vector< char >
+make_escape(size_t n)
+{
+	std::vector< char > esc;
+	esc.reserve(n * 2);
+	for (size_t i = 0; i < n; ++i) {
+		unsigned char c = static_cast<unsigned char>(i * 31);
+		if (c == '\\') {
+			esc.push_back('\\');
+			esc.push_back('\\');
+		} else if (c < 0x20 || c > 0x7e) {
+			esc.push_back('\\');
+			esc.push_back('0' + (c >> 6));
+			esc.push_back('0' + ((c >> 3) & 7));
+			esc.push_back('0' + (c & 7));
+		} else {
+			esc.push_back(c);
+		}
+	}
+	return esc;
+}
+
+/** Per-character state machine, as used before the buffer decoder */
+void
+ByteaHexStateMachine(::benchmark::State& state)
+{
+	std::vector< char > hex = make_hex(state.range(0));
+	for (auto _ : state) {
+		std::vector< byte > data;
+		auto res = io::detail::bytea_parser().parse(hex.begin(), hex.end(),
+				std::back_inserter(data));
+		::benchmark::DoNotOptimize(res);
+		::benchmark::DoNotOptimize(data.data());
+	}
+	state.SetBytesProcessed(state.iterations() * hex.size());
+}
+
+void
+ByteaHexDecode(::benchmark::State& state)
+{
+	std::vector< char > hex = make_hex(state.range(0));
+	bytea val;
+	for (auto _ : state) {
+		io::protocol_read< TEXT_DATA_FORMAT >(hex.begin(), hex.end(), val);
+		::benchmark::DoNotOptimize(val.data());
+	}
+	state.SetBytesProcessed(state.iterations() * hex.size());
+}
+
+void
+ByteaEscapeDecode(::benchmark::State& state)
+{
+	std::vector< char > esc = make_escape(state.range(0));
+	bytea val;
+	for (auto _ : state) {
+		io::protocol_read< TEXT_DATA_FORMAT >(esc.begin(), esc.end(), val);
+		::benchmark::DoNotOptimize(val.data());
+	}
+	state.SetBytesProcessed(state.iterations() * esc.size());
+}
+
+}  // namespace
+
+BENCHMARK(ByteaHexStateMachine)->RangeMultiplier(8)->Range(1 << 10, 64 << 20)
+		->Unit(::benchmark::kMicrosecond);
+BENCHMARK(ByteaHexDecode)->RangeMultiplier(8)->Range(1 << 10, 64 << 20)
+		->Unit(::benchmark::kMicrosecond);
+BENCHMARK(ByteaEscapeDecode)->RangeMultiplier(8)->Range(1 << 10, 64 << 20)
+		->Unit(::benchmark::kMicrosecond);
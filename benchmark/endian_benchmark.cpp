@@ -0,0 +1,108 @@
+/*
+ * endian_benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <tip/db/pg/common.hpp>
+#include <tip/db/pg/io/vector.hpp>
+#include <tip/util/endian.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+template < typename T >
+void
+ByteByByte(::benchmark::State& state)
+{
+	size_t n = state.range(0);
+	std::vector< char > src(n * sizeof(T), 0x5a);
+	std::vector< T > dst(n);
+	for (auto _ : state) {
+		char const* p = src.data();
+		for (size_t i = 0; i < n; ++i) {
+			T tmp;
+			char* q = reinterpret_cast<char*>(&tmp);
+			for (size_t b = 0; b < sizeof(T); ++b)
+				*q++ = *p++;
+			dst[i] = tip::util::endian::big_to_native(tmp);
+		}
+		::benchmark::DoNotOptimize(dst.data());
+		::benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+template < typename T >
+void
+BulkScalar(::benchmark::State& state)
+{
+	size_t n = state.range(0);
+	std::vector< char > src(n * sizeof(T), 0x5a);
+	std::vector< T > dst(n);
+	for (auto _ : state) {
+		tip::util::endian::detail::bulk_reverse_scalar< sizeof(T) >(
+				src.data(), reinterpret_cast<char*>(dst.data()), n);
+		::benchmark::DoNotOptimize(dst.data());
+		::benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+template < typename T >
+void
+BulkDispatch(::benchmark::State& state)
+{
+	size_t n = state.range(0);
+	std::vector< char > src(n * sizeof(T), 0x5a);
+	std::vector< T > dst(n);
+	for (auto _ : state) {
+		tip::util::endian::big_to_native(src.data(), dst.data(), n);
+		::benchmark::DoNotOptimize(dst.data());
+		::benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+void
+BinaryIntArray(::benchmark::State& state)
+{
+	using namespace tip::db::pg;
+	size_t n = state.range(0);
+	std::vector< byte > buffer;
+	io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+	io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(0));
+	io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(oids::type::int4));
+	io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(n));
+	io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+	for (size_t i = 0; i < n; ++i) {
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(sizeof(integer)));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(i));
+	}
+	std::vector< integer > vals;
+	for (auto _ : state) {
+		io::protocol_read< BINARY_DATA_FORMAT >(buffer.begin(), buffer.end(), vals);
+		::benchmark::DoNotOptimize(vals.data());
+	}
+	state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(ByteByByte, int16_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BulkScalar, int16_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BulkDispatch, int16_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(ByteByByte, int32_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BulkScalar, int32_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BulkDispatch, int32_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(ByteByByte, int64_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BulkScalar, int64_t)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BulkDispatch, int64_t)->Range(64, 1 << 16);
+BENCHMARK(BinaryIntArray)->Range(64, 1 << 16);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,109 @@
+/*
+ * fsm_benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <tip/db/pg/detail/connection_fsm.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace {
+
+namespace pg = tip::db::pg;
+namespace asio_config = pg::asio_config;
+using namespace pg::events;
+
+/**
+ * Transport that doesn't do any I/O, the events are fed to the
+ * connection directly
+ */
+struct null_transport {
+    using io_service_ptr = asio_config::io_service_ptr;
+    using connect_callback = std::function< void (asio_config::error_code const&) >;
+
+    null_transport(io_service_ptr) {}
+
+    void
+    connect_async(pg::connection_options const&, connect_callback cb,
+            pg::detail::connection_caches const&)
+    {
+        asio_config::error_code ec;
+        cb(ec);
+    }
+
+    bool
+    connected() const
+    {
+        return true;
+    }
+
+    void
+    close()
+    {
+    }
+
+    std::string const&
+    host() const
+    {
+        static const std::string localhost{"localhost"};
+        return localhost;
+    }
+
+    template < typename BufferType, typename HandlerType >
+    void
+    async_read(BufferType&, HandlerType)
+    {
+    }
+
+    template < typename BufferType, typename HandlerType >
+    void
+    async_write(BufferType const&, HandlerType)
+    {
+    }
+};
+
+const int rows_per_result = 16;
+/** Execute, row description, command complete and ready for query */
+const int events_per_query = 4;
+
+/**
+ * Each iteration is a simple query in a transaction: the query is sent,
+ * then the connection processes a row description, the data rows,
+ * a command complete and a ready for query.
+ */
+template < typename Mutex >
+void
+BM_ConnectionEvents(benchmark::State& state)
+{
+    using connection_type = pg::detail::concrete_connection< null_transport, Mutex >;
+    auto svc = std::make_shared< asio_config::io_service >();
+    std::shared_ptr< connection_type > c(new connection_type(svc, {}, {}));
+    c->process_event(pg::connection_options::parse("main=tcp://user@localhost:5432[db]"));
+    c->process_event(ready_for_query{ 'I' });
+    c->process_event(begin{});
+
+    for (auto _ : state) {
+        c->process_event(execute{ "select", {}, {}, false });
+        c->process_event(row_description{});
+        for (int i = 0; i < rows_per_result; ++i) {
+            c->process_event(row_event{});
+        }
+        c->process_event(pg::detail::command_complete{ "SELECT 16" });
+        c->process_event(ready_for_query{ 'T' });
+    }
+    state.SetItemsProcessed(state.iterations() * (rows_per_result + events_per_query));
+
+    c->process_event(rollback{});
+    c->process_event(ready_for_query{ 'I' });
+    c->process_event(terminate{});
+}
+
+BENCHMARK_TEMPLATE(BM_ConnectionEvents, std::mutex);
+BENCHMARK_TEMPLATE(BM_ConnectionEvents, ::afsm::none);
+
+}  // namespace
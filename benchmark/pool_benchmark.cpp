@@ -0,0 +1,96 @@
+/*
+ * pool_benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <tip/db/pg/detail/handoff_queue.hpp>
+
+#include <mutex>
+#include <queue>
+#include <stack>
+
+namespace {
+
+using tip::db::pg::detail::handoff_queue;
+
+const int idle_resources = 4;
+
+/**
+ * Mutex-guarded idle stack and request queue, as the connection pool
+ * used to do it
+ */
+class locked_queue {
+public:
+    bool
+    acquire(int& req, int& res)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (!idle_.empty()) {
+            res = idle_.top();
+            idle_.pop();
+            return true;
+        }
+        waiting_.push(req);
+        return false;
+    }
+    bool
+    release(int& res, int& req)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (!waiting_.empty()) {
+            req = waiting_.front();
+            waiting_.pop();
+            return true;
+        }
+        idle_.push(res);
+        return false;
+    }
+private:
+    std::mutex          mutex_;
+    std::stack<int>     idle_;
+    std::queue<int>     waiting_;
+};
+
+template < typename Queue >
+Queue&
+shared_queue()
+{
+    static Queue* q = []()
+    {
+        Queue* q = new Queue;
+        int req;
+        for (int i = 0; i < idle_resources; ++i)
+            q->release(i, req);
+        return q;
+    }();
+    return *q;
+}
+
+/**
+ * Each iteration is a request for a resource. If the resource is not
+ * available, the request is enqueued and served by the thread that
+ * releases a resource.
+ */
+template < typename Queue >
+void
+BM_PoolHandoff(benchmark::State& state)
+{
+    Queue& q = shared_queue<Queue>();
+    for (auto _ : state) {
+        int req = state.thread_index(), res = 0;
+        if (q.acquire(req, res)) {
+            while (q.release(res, req)) {
+                benchmark::DoNotOptimize(req);
+            }
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_PoolHandoff, locked_queue)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PoolHandoff, handoff_queue<int, int>)->ThreadRange(1, 16)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,39 @@
+/*
+ * scram_benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <tip/db/pg/detail/scram.hpp>
+
+#include <memory>
+
+namespace {
+
+namespace pg = tip::db::pg;
+
+const std::string server_first = "r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,"
+        "s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096";
+
+/**
+ * Client side of a SCRAM exchange with 4096 iterations, the keys are
+ * derived for every exchange or taken from the cache of the pool.
+ */
+void
+BM_ScramExchange(benchmark::State& state)
+{
+    std::shared_ptr< pg::detail::scram_key_cache > cache;
+    if (state.range(0))
+        cache = std::make_shared< pg::detail::scram_key_cache >();
+    for (auto _ : state) {
+        pg::detail::scram_client client("pencil", cache, "", "rOprNGfwEbeRWgbNEkqO");
+        benchmark::DoNotOptimize(client.final_message(server_first));
+    }
+}
+
+BENCHMARK(BM_ScramExchange)->Arg(0)->Arg(1);
+
+}  // namespace
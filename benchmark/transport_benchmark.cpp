@@ -0,0 +1,144 @@
+/*
+ * transport_benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <tip/db/pg/detail/transport.hpp>
+#include <tip/db/pg/detail/uring_transport.hpp>
+
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace pg = tip::db::pg;
+namespace asio_config = pg::asio_config;
+
+const std::size_t request_size = 64;
+const std::size_t read_size = 8192;
+
+/**
+ * Stand-in server, replies to each request with a response of the
+ * given size. Runs in a thread of its own with blocking I/O.
+ */
+class reply_server {
+public:
+    using tcp = asio_config::tcp;
+
+    reply_server(std::size_t response_size)
+        : acceptor_(service_, tcp::endpoint(
+                ASIO_NAMESPACE::ip::address_v4::loopback(), 0)),
+          socket_(service_),
+          response_(response_size, 'x')
+    {
+        thread_ = std::thread([this](){ run(); });
+    }
+    ~reply_server()
+    {
+        thread_.join();
+    }
+
+    std::string
+    address() const
+    {
+        std::ostringstream os;
+        os << "127.0.0.1:" << acceptor_.local_endpoint().port();
+        return os.str();
+    }
+private:
+    void
+    run()
+    {
+        asio_config::error_code ec;
+        acceptor_.accept(socket_, ec);
+        std::vector< char > request(request_size);
+        while (!ec) {
+            ASIO_NAMESPACE::read(socket_, ASIO_NAMESPACE::buffer(request), ec);
+            if (!ec)
+                ASIO_NAMESPACE::write(socket_, ASIO_NAMESPACE::buffer(response_), ec);
+        }
+    }
+
+    asio_config::io_service service_;
+    tcp::acceptor           acceptor_;
+    tcp::socket             socket_;
+    std::vector< char >     response_;
+    std::thread             thread_;
+};
+
+/**
+ * Each iteration is a request of 64 bytes and a response of the size
+ * given by the argument, read in chunks as a connection does.
+ */
+template < typename TransportType >
+void
+BM_TransportRoundTrip(benchmark::State& state)
+{
+    std::size_t response_size = state.range(0);
+    reply_server server(response_size);
+    auto svc = std::make_shared< asio_config::io_service >();
+    // The operations are run one by one, keep the service from stopping
+    asio_config::io_service::work work(*svc);
+    TransportType transport(svc);
+
+    pg::connection_options opts = pg::connection_options::parse(
+            "main=tcp://user@localhost:5432[db]");
+    opts.uri = server.address();
+    bool connected = false;
+    transport.connect_async(opts,
+            [&](asio_config::error_code const& ec){ connected = !ec; });
+    while (!connected && svc->run_one()) {}
+    if (!connected) {
+        state.SkipWithError("Failed to connect");
+        return;
+    }
+
+    std::vector< char > request(request_size, 'q');
+    std::vector< char > incoming(read_size);
+    std::size_t received = 0;
+    bool failed = false;
+    std::function< void() > read_more = [&]()
+    {
+        auto buffer = ASIO_NAMESPACE::buffer(incoming);
+        transport.async_read(buffer,
+        [&](asio_config::error_code const& ec, std::size_t n)
+        {
+            if (ec) {
+                failed = true;
+                return;
+            }
+            received += n;
+            if (received < response_size)
+                read_more();
+        });
+    };
+
+    for (auto _ : state) {
+        received = 0;
+        transport.async_write(ASIO_NAMESPACE::buffer(request),
+                [](asio_config::error_code const&, std::size_t){});
+        read_more();
+        while (received < response_size && !failed && svc->run_one()) {}
+        if (failed) {
+            state.SkipWithError("Read failed");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * response_size);
+
+    transport.close();
+    svc->poll();
+}
+
+BENCHMARK_TEMPLATE(BM_TransportRoundTrip, pg::detail::tcp_transport)
+    ->Arg(64)->Arg(16 * 1024)->Arg(256 * 1024);
+BENCHMARK_TEMPLATE(BM_TransportRoundTrip, pg::detail::uring_transport)
+    ->Arg(64)->Arg(16 * 1024)->Arg(256 * 1024);
+
+}  // namespace
@@ -27,6 +27,7 @@ typedef ASIO_NAMESPACE::io_service io_service;
 typedef std::shared_ptr< io_service > io_service_ptr;
 typedef ASIO_NAMESPACE::ip::tcp tcp;
 typedef ASIO_NAMESPACE::local::stream_protocol stream_protocol;
+typedef ASIO_NAMESPACE::steady_timer steady_timer;
 
 #ifdef WITH_BOOST_ASIO
 typedef boost::system::error_code error_code;
@@ -138,6 +138,8 @@
 #include <functional>
 #include <memory>
 #include <map>
+#include <array>
+#include <chrono>
 #include <boost/integer.hpp>
 #include <boost/optional.hpp>
 
@@ -254,6 +256,64 @@ struct dbalias : std::string {
     }
 };
 
+/**
+ * Role of a database host behind an alias.
+ * Read-only transactions are routed to replicas, all other transactions
+ * to the primary.
+ */
+enum class host_role {
+    primary,    //!< accepts writes, default
+    replica     //!< serves read-only transactions
+};
+
+::std::ostream&
+operator << (::std::ostream& os, host_role val);
+
+/**
+ * Kind of server session acceptable for a connection, checked after
+ * authentication. Servers that don't report `in_hot_standby` and
+ * `default_transaction_read_only` parameters (before PostgreSQL 14)
+ * are always accepted.
+ */
+enum class target_session_attrs {
+    any,        //!< any server, default
+    read_write, //!< a primary server
+    read_only   //!< a hot standby or a read-only session
+};
+
+::std::ostream&
+operator << (::std::ostream& os, target_session_attrs val);
+
+/**
+ * @brief TCP socket settings, applied when a connection is established.
+ *
+ * Zero values leave the system defaults.
+ */
+struct tcp_options {
+    using seconds       = ::std::chrono::seconds;
+    using milliseconds  = ::std::chrono::milliseconds;
+
+    /** TCP_NODELAY, send small messages without waiting to coalesce them */
+    bool            no_delay            = true;
+    /** SO_KEEPALIVE, probe the idle connection to detect a dead peer */
+    bool            keepalives          = true;
+    seconds         keepalives_idle     = seconds::zero();  /**< TCP_KEEPIDLE */
+    seconds         keepalives_interval = seconds::zero();  /**< TCP_KEEPINTVL */
+    int             keepalives_count    = 0;                /**< TCP_KEEPCNT */
+    /**
+     * TCP_USER_TIMEOUT, how long the sent data may remain unacknowledged
+     * before the connection is closed
+     */
+    milliseconds    user_timeout        = milliseconds::zero();
+    int             recv_buffer_size    = 0;                /**< SO_RCVBUF */
+    int             send_buffer_size    = 0;                /**< SO_SNDBUF */
+    /**
+     * How long the connections of a pool reuse the resolved addresses of
+     * a host. Zero resolves the host on every connect.
+     */
+    seconds         dns_cache_ttl       = seconds{60};
+};
+
 /**
  * @brief Postgre connection options
  */
@@ -264,6 +324,45 @@ struct connection_options {
     std::string database;   /**< Database name */
     std::string user;       /**< Database user name */
     std::string password;   /**< Database user's password */
+    host_role   role = host_role::primary; /**< Role of the host behind the alias */
+    /** Server session kind to accept */
+    target_session_attrs session_attrs = target_session_attrs::any;
+    /** Try the hosts of a multi-host uri in random order */
+    bool        random_host_order = false;
+    /**
+     * Process the connection events without locking. All calls to the
+     * connection must be made by the thread running its io_service, e.g.
+     * an io_service run by a single thread or a shard.
+     */
+    bool        single_threaded = false;
+    /** Socket settings of a tcp connection */
+    tcp_options tcp;
+    /**
+     * Root certificates file to verify the server certificate and host
+     * name of an ssl connection with. If empty, the server is not verified.
+     */
+    std::string ssl_root_cert;
+    /**
+     * Do the socket I/O of a tcp connection through io_uring, falls back
+     * to the reactor when io_uring is not available
+     */
+    bool        io_uring = false;
+    //@{
+    /**
+     * @name Bounds of the receive buffer size.
+     * The buffer grows while a large result is streaming and shrinks back
+     * when the connection is idle.
+     */
+    std::size_t read_buffer_min = 8 * 1024;
+    std::size_t read_buffer_max = 256 * 1024;
+    //@}
+
+    /**
+     * Hosts of a multi-host uri, `host1:port,host2:port`, in the order
+     * they are listed.
+     */
+    std::vector< std::string >
+    hosts() const;
 
     /**
      * Generate an alias from username, database and uri if the alias was not
@@ -280,6 +379,11 @@ struct connection_options {
      * opts = "ssl://localhost:5432[database]"_pg;
      * // Connection via UNIX socket
      * opts = "socket:///tmp/.s.PGSQL.5432[database]"_pg;
+     * // A read replica for the same alias
+     * opts = "aliasname=tcp://user@replica:5432[database]?role=replica"_pg;
+     * // Fail over between hosts, connect only to a primary
+     * opts = "aliasname=tcp://user@host1:5432,host2:5432[database]"
+     *         "?target_session_attrs=read-write&load_balance_hosts=random"_pg;
      * @endcode
      * @see connstring
      */
@@ -287,6 +391,57 @@ struct connection_options {
     parse(std::string const&);
 };
 
+/**
+ * Priority class of a transaction request. When requests wait for a
+ * connection, higher priority requests get connections more often.
+ * @see pool_options::priority_weights
+ */
+enum class transaction_priority {
+    high,   //!< latency-critical requests
+    normal, //!< default
+    low     //!< batch jobs
+};
+
+/** Number of transaction priority classes */
+const ::std::size_t TRANSACTION_PRIORITIES = 3;
+
+/**
+ * @brief Connection pool sizing and connection recycling options
+ */
+struct pool_options {
+    using duration = ::std::chrono::milliseconds;
+    using priority_weights_type =
+            ::std::array< unsigned, TRANSACTION_PRIORITIES >;
+
+    /** Number of idle connections the pool tries to keep open */
+    size_t      min_idle        = 1;
+    /** Maximum number of connections in the pool */
+    size_t      max_size        = 4;
+    /**
+     * Connections beyond min_idle are closed after being idle for that long.
+     * Zero means never.
+     */
+    duration    max_idle_time   = duration::zero();
+    /**
+     * Connections are closed and replaced after being open for that long.
+     * Zero means never.
+     */
+    duration    max_lifetime    = duration::zero();
+    /**
+     * Share of connections given to waiting requests of each priority
+     * class, indexed by transaction_priority.
+     */
+    priority_weights_type priority_weights = {{ 8, 4, 1 }};
+
+    pool_options() {}
+    explicit
+    pool_options(size_t max, size_t min = 1,
+            duration idle = duration::zero(),
+            duration lifetime = duration::zero())
+        : min_idle{min}, max_size{max}, max_idle_time{idle},
+          max_lifetime{lifetime} {}
+};
+
 /**
  * The isolation level of a transaction determines what data the transaction
  * can see when other transactions are running concurrently
@@ -302,14 +457,34 @@ enum class isolation_level {
 operator << (::std::ostream& os, isolation_level val);
 
 struct transaction_mode {
-    isolation_level   isolation     = isolation_level::read_committed;
-    bool              read_only     = false;
-    bool              deferrable    = false;
+    using duration = ::std::chrono::milliseconds;
+
+    isolation_level         isolation     = isolation_level::read_committed;
+    bool                    read_only     = false;
+    bool                    deferrable    = false;
+    transaction_priority    priority      = transaction_priority::normal;
+    /**
+     * Transaction deadline, counted from the transaction start. When it
+     * expires, the running query is cancelled and the transaction is
+     * rolled back. Zero means no deadline.
+     */
+    duration                timeout       = duration::zero();
+    /**
+     * Run a single statement without BEGIN and COMMIT. The statement is
+     * committed by the server when it completes and the connection returns
+     * to the pool on ReadyForQuery. Isolation level, read-only and
+     * deferrable settings are not sent to the server.
+     */
+    bool                    autocommit    = false;
 
     constexpr transaction_mode() {}
     explicit constexpr
-    transaction_mode(isolation_level i, bool ro = false, bool def = false)
-        : isolation{i}, read_only{ro}, deferrable{def} {}
+    transaction_mode(isolation_level i, bool ro = false, bool def = false,
+            transaction_priority p = transaction_priority::normal)
+        : isolation{i}, read_only{ro}, deferrable{def}, priority{p} {}
+    explicit constexpr
+    transaction_mode(transaction_priority p)
+        : priority{p} {}
 };
 
 ::std::ostream&
@@ -412,6 +587,8 @@ struct begin {
     transaction_callback        started;
     error_callback              error;
     transaction_mode            mode = transaction_mode{};
+    /** Called after the transaction is committed */
+    simple_callback             finished;
 
     begin()
         : started{}, error{}
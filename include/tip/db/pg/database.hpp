@@ -9,9 +9,11 @@
 #define TIP_DB_PG_DATABASE_HPP_
 
 #include <string>
+#include <chrono>
 #include <memory>
 #include <functional>
 #include <map>
+#include <vector>
 #include <future>
 #include <boost/optional.hpp>
 
@@ -19,6 +21,7 @@
 #include <tip/db/pg/future_config.hpp>
 #include <tip/db/pg/common.hpp>
 #include <tip/db/pg/error.hpp>
+#include <tip/db/pg/metrics.hpp>
 
 
 namespace tip {
@@ -28,6 +31,81 @@ namespace pg {
 namespace detail {
 struct database_impl;
 }
+
+/**
+ * @brief Policy for re-running a transaction that failed with a transient
+ *         error, e.g. a serialization failure or a deadlock.
+ * @see db_service::run_transaction
+ */
+struct retry_policy {
+    using duration          = ::std::chrono::milliseconds;
+    using sqlstates_type    = ::std::vector< sqlstate::code >;
+
+    /** Maximum number of attempts, including the first one */
+    ::std::size_t   max_attempts    = 5;
+    /**
+     * Upper bound of the delay before the first retry, doubles with each
+     * next retry
+     */
+    duration        base_delay      = duration{ 10 };
+    /** Upper bound of the delay before any retry */
+    duration        max_delay       = duration{ 1000 };
+    /** SQLSTATE codes a transaction is retried on */
+    sqlstates_type  sqlstates       = sqlstates_type{
+        sqlstate::serialization_failure,
+        sqlstate::deadlock_detected
+    };
+
+    retry_policy() {}
+    explicit
+    retry_policy(::std::size_t attempts,
+            duration base = duration{ 10 },
+            duration max = duration{ 1000 })
+        : max_attempts{attempts}, base_delay{base}, max_delay{max} {}
+
+    /** The transaction failed with the error can be run again */
+    bool
+    retryable(error::db_error const&) const;
+    /**
+     * Upper bound of the delay before a retry, the actual delay is chosen
+     * uniformly from [0, bound] to spread the retries of concurrent
+     * transactions.
+     * @param retry retry number, starting from 1
+     */
+    duration
+    delay_bound(::std::size_t retry) const;
+};
+/**
+ * @brief Options of the threads running the database service.
+ * @see db_service::start
+ */
+struct runner_options {
+    using duration          = ::std::chrono::milliseconds;
+
+    /**
+     * Number of threads running a single shard service, zero means one per
+     * hardware thread. With several shards, a thread runs each shard.
+     */
+    ::std::size_t   threads             = 0;
+    /** Pin each thread to a CPU, thread N to CPU N */
+    bool            pin_threads         = false;
+    /**
+     * Interval of the event loop lag probe, a timer measuring how late the
+     * handlers run. Zero disables the probe.
+     */
+    duration        lag_probe_interval  = duration{ 100 };
+    /**
+     * Time given to the running transactions to finish on stop, after that
+     * the threads are stopped.
+     */
+    duration        drain_timeout       = duration{ 5000 };
+
+    runner_options() {}
+    explicit
+    runner_options(::std::size_t t, bool pin = false)
+        : threads{t}, pin_threads{pin} {}
+};
+
 /**
  * Database connection manager.
  * Synopsis:
@@ -72,11 +150,35 @@ public:
      */
     static void
     initialize(size_t pool_size, connection_params const& defaults);
+    /**
+     * @brief Initialize the database service with the default pool options
+     *         per alias and default connection parameters.
+     *
+     * With more than one shard, the service runs an io_service per shard,
+     * each with its own connection pools sized by the pool options, and
+     * run() runs every shard on its own thread. A transaction started from
+     * a shard thread uses a connection of that shard, a transaction started
+     * from any other thread goes to the next shard round-robin. Callbacks
+     * are called on the thread of the shard that runs the transaction.
+     * To start a transaction on a particular shard, post the call to the
+     * shard.
+     *
+     * @param po pool sizing and connection recycling options
+     * @param defaults default settings for the connection
+     * @param shards number of shards, zero means one per hardware thread
+     * @throws tip::db::pg::error::connection_error if the number of shards
+     *          is changed after connections were registered.
+     */
+    static void
+    initialize(pool_options const& po, connection_params const& defaults,
+            size_t shards = 1);
 
     /**
      *    @brief Add a connection specification.
      *
      *    Requires an alias, for the database to be referenced by it later.
+     *    Adding a connection with the `role=replica` option to an existing
+     *    alias adds a replica host for read-only transactions.
      *    @param connection_string
      *    @param pool_size A connection can have a pool size different from
      *             other connections.
@@ -90,6 +192,22 @@ public:
     static void
     add_connection(connection_options const& co,
             optional_size pool_size = optional_size());
+    /**
+     *    @brief Add a connection specification with pool options.
+     *
+     *    The pool opens min_idle connections in parallel right away and keeps
+     *    that many idle connections open, up to max_size connections in total.
+     *    @param connection_string
+     *    @param po pool sizing and connection recycling options
+     *    @throws tip::db::pg::error::connection_error if the connection string
+     *            or the pool options cannot be used.
+     */
+    static void
+    add_connection(std::string const& connection_string,
+            pool_options const& po);
+
+    static void
+    add_connection(connection_options const& co, pool_options const& po);
     /**
      *     @brief Create a connection or retrieve a connection from the connection pool
      *         and start a transaction.
@@ -101,6 +219,8 @@ public:
      *    didn't reach it's limit, will create a new one.
      *    If the pool is full and no idle connections are available,
      *    will return the first connection that becomes idle.
+     *    Read-only transactions are routed to the replica of the alias with
+     *    the least outstanding requests, if the alias has replicas.
      *
      *    @param alias database alias
      *    @param result callback function that will be called when a connection
@@ -149,14 +269,117 @@ public:
         auto future = begin_async< _Promise >(alias, mode);
         return future.get();
     }
+    /**
+     *    @brief Run a transaction, re-running it on transient errors.
+     *
+     *    Starts a transaction like begin does and passes it to the body.
+     *    The body runs the statements and commits the transaction, as a
+     *    begin callback does. If the transaction fails with an SQLSTATE
+     *    listed in the policy, it is rolled back and the body is called
+     *    again with a new transaction after a random delay, until the
+     *    attempts are exhausted.
+     *
+     *    The body must not have effects outside the transaction that cannot
+     *    be repeated. Autocommit mode is not supported, the transaction is
+     *    always wrapped in BEGIN and COMMIT.
+     *
+     *    @param alias database alias
+     *    @param mode transaction mode
+     *    @param body function running the transaction statements
+     *    @param done called after the transaction is committed
+     *    @param error called with the error of the last attempt
+     *    @param policy retry policy
+     *    @throws tip::db::pg::error::connection_error if the alias is not
+     *          registered with the database service.
+     */
+    static void
+    run_transaction(dbalias const& alias, transaction_mode const& mode,
+            transaction_callback const& body, simple_callback const& done,
+            error_callback const& error,
+            retry_policy const& policy = retry_policy{});
 
+    /**
+     * @brief Snapshot of the connection pool metrics for the alias.
+     * For an alias with replicas, the primary pool metrics.
+     * @throws tip::db::pg::error::connection_error if the alias is not
+     *          registered with the database service.
+     */
+    static pool_metrics
+    metrics(dbalias const&);
+    /**
+     * @brief Snapshot of metrics of all connection pools
+     */
+    static std::vector< pool_metrics >
+    metrics();
+
+    /**
+     * @brief Run the service. With several shards, runs the first shard on
+     *         the calling thread and the others on new threads, returns
+     *         after all of them stop. If the service was started with
+     *         start(), waits until it stops.
+     */
     static void
     run();
+    /**
+     * @brief Start threads running the service and return.
+     *
+     * The threads run until stop() is called. With several shards, the
+     * service runs a thread per shard.
+     * @throws tip::db::pg::error::db_error if the service is already started
+     */
+    static void
+    start(runner_options const& = runner_options{});
+    /**
+     * @brief Stop the service.
+     *
+     * New transactions cannot be started, the connections are closed after
+     * the running transactions finish. If the service was started with
+     * start(), waits for the threads up to the drain timeout, unless called
+     * from one of them.
+     */
     static void
     stop();
+    /**
+     * @brief Event loop lag of the threads started with start(), a
+     *         histogram per shard.
+     *
+     * The lag is the delay of running a timer handler after it became
+     * due, growing values mean the threads are saturated.
+     */
+    static std::vector< latency_histogram >
+    event_loop_lag();
 
+    /**
+     * @brief The io_service of the calling thread's shard, or of the first
+     *         shard for a thread that doesn't run one.
+     */
     static asio_config::io_service_ptr
     io_service();
+    /**
+     * @brief The io_service of a shard
+     * @throws tip::db::pg::error::db_error if the shard number is out of
+     *          range
+     */
+    static asio_config::io_service_ptr
+    io_service(size_t shard);
+
+    //@{
+    /** @name Shards */
+    static size_t
+    shard_count();
+    /**
+     * @brief Shard run by the calling thread, empty for a thread that
+     *         doesn't run a shard.
+     */
+    static optional_size
+    current_shard();
+    /**
+     * @brief Run the handler on the thread of the shard, e.g. to start
+     *         a transaction using the shard's connections.
+     */
+    static void
+    post(size_t shard, simple_callback const&);
+    //@}
 private:
     // No instances
     db_service() {}
@@ -11,6 +11,7 @@
 #include <boost/logic/tribool.hpp>
 #include <algorithm>
 #include <cctype>
+#include <vector>
 
 namespace tip {
 namespace db {
@@ -77,7 +78,7 @@ private:
 				}
 			case nibble_two:
 				if (std::isxdigit(input)) {
-					*data++ = (hex_to_byte(input) << 4) | most_sighificant_nibble_;
+					*data++ = (most_sighificant_nibble_ << 4) | hex_to_byte(input);
 					state_ = nibble_one;
 					return true;
 				} else {
@@ -93,6 +94,20 @@ private:
 	hex_to_byte(char);
 };
 
+/**
+ * Decode bytea text representation from a contiguous buffer.
+ * Both hex (`\\x...`) and escape output formats are accepted. The output
+ * is sized once up front and the hex digits are decoded with SIMD
+ * kernels when the CPU supports them. An empty input is an empty value
+ * in escape format.
+ * @param begin start of the text representation
+ * @param end end of the text representation
+ * @param data output buffer, contents are replaced
+ * @return true if the whole input is a valid bytea value
+ */
+bool
+decode_bytea(char const* begin, char const* end, std::vector<char>& data);
+
 }  // namespace detail
 }  // namespace io
 }  // namespace pg
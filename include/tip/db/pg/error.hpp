@@ -58,6 +58,20 @@ public:
     );
 };
 
+/**
+ * @brief A query or transaction deadline expired.
+ * The query was cancelled on the server.
+ */
+class query_timeout : public query_error {
+public:
+    explicit query_timeout( std::string const& );
+    query_timeout(std::string const& message,
+        std::string severity,
+        std::string code,
+        std::string detail
+    );
+};
+
 class transaction_closed : public query_error {
 public:
     transaction_closed() : query_error("Transaction already closed") {}
@@ -0,0 +1,193 @@
+/**
+ *  @file tip/db/pg/field_view.hpp
+ *
+ *  @date Oct 18, 2026
+ *  @author: zmij
+ */
+
+#ifndef TIP_DB_PG_FIELD_VIEW_HPP_
+#define TIP_DB_PG_FIELD_VIEW_HPP_
+
+#include <tip/db/pg/common.hpp>
+
+#include <boost/functional/hash.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+namespace tip {
+namespace db {
+namespace pg {
+
+namespace detail {
+class result_impl;
+}
+
+/**
+ * @brief Read-only view of a field's data in a result set.
+ *
+ * Refers to the raw bytes of the field as they were received from the
+ * server, no copy is made. The view shares ownership of the result set
+ * data, so it stays valid after the resultset object it was obtained
+ * from is destroyed.
+ * @code
+ * std::unordered_set< field_view > keys;
+ * for (auto row : res) {
+ *     keys.insert(row["key"].view());
+ * }
+ * @endcode
+ */
+class field_view {
+public:
+    typedef char            value_type;
+    typedef char const*     const_iterator;
+    typedef const_iterator  iterator;
+    typedef std::size_t     size_type;
+    typedef std::shared_ptr< detail::result_impl const > owner_ptr;
+public:
+    /** @brief Construct a view of a null value */
+    field_view() : owner_(), data_(nullptr), size_(0), null_(true) {}
+    /**
+     * @brief Construct a view of field data
+     * Used internally by the library
+     */
+    field_view(owner_ptr owner, char const* data, size_type size, bool null)
+        : owner_(owner), data_(data), size_(size), null_(null) {}
+
+    //@{
+    /** @name Sequence interface */
+    char const*
+    data() const
+    { return data_; }
+    size_type
+    size() const
+    { return size_; }
+    bool
+    empty() const
+    { return size_ == 0; }
+
+    const_iterator
+    begin() const
+    { return data_; }
+    const_iterator
+    end() const
+    { return data_ + size_; }
+
+    char
+    operator[](size_type index) const
+    { return data_[index]; }
+    //@}
+
+    /** @brief Is the field value null */
+    bool
+    is_null() const
+    { return null_; }
+
+    /** @brief Non-owning string reference to the data */
+    boost::string_ref
+    str() const
+    { return boost::string_ref(data_, size_); }
+
+    /** @brief Copy the data to a string */
+    std::string
+    to_string() const
+    { return std::string(data_, size_); }
+
+    int
+    compare(field_view const& rhs) const
+    { return compare(rhs.data_, rhs.size_); }
+    int
+    compare(std::string const& rhs) const
+    { return compare(rhs.data(), rhs.size()); }
+    int
+    compare(char const* rhs) const
+    { return compare(rhs, std::strlen(rhs)); }
+private:
+    int
+    compare(char const* rhs, size_type rhs_size) const
+    {
+        size_type n = std::min(size_, rhs_size);
+        int res = n ? std::memcmp(data_, rhs, n) : 0;
+        if (res)
+            return res;
+        return size_ < rhs_size ? -1 : (size_ > rhs_size ? 1 : 0);
+    }
+
+    owner_ptr   owner_;
+    char const* data_;
+    size_type   size_;
+    bool        null_;
+};
+
+//@{
+/** @name Comparison */
+inline bool
+operator == (field_view const& lhs, field_view const& rhs)
+{ return lhs.compare(rhs) == 0; }
+inline bool
+operator != (field_view const& lhs, field_view const& rhs)
+{ return lhs.compare(rhs) != 0; }
+inline bool
+operator < (field_view const& lhs, field_view const& rhs)
+{ return lhs.compare(rhs) < 0; }
+
+inline bool
+operator == (field_view const& lhs, std::string const& rhs)
+{ return lhs.compare(rhs) == 0; }
+inline bool
+operator == (std::string const& lhs, field_view const& rhs)
+{ return rhs.compare(lhs) == 0; }
+inline bool
+operator != (field_view const& lhs, std::string const& rhs)
+{ return lhs.compare(rhs) != 0; }
+inline bool
+operator != (std::string const& lhs, field_view const& rhs)
+{ return rhs.compare(lhs) != 0; }
+
+inline bool
+operator == (field_view const& lhs, char const* rhs)
+{ return lhs.compare(rhs) == 0; }
+inline bool
+operator == (char const* lhs, field_view const& rhs)
+{ return rhs.compare(lhs) == 0; }
+inline bool
+operator != (field_view const& lhs, char const* rhs)
+{ return lhs.compare(rhs) != 0; }
+inline bool
+operator != (char const* lhs, field_view const& rhs)
+{ return rhs.compare(lhs) != 0; }
+//@}
+
+/** @brief Hash of the field data, for boost containers */
+inline std::size_t
+hash_value(field_view const& v)
+{
+    return boost::hash_range(v.begin(), v.end());
+}
+
+std::ostream&
+operator << (std::ostream&, field_view const&);
+
+}  // namespace pg
+}  // namespace db
+}  // namespace tip
+
+namespace std {
+
+template <>
+struct hash< ::tip::db::pg::field_view > {
+    std::size_t
+    operator()(::tip::db::pg::field_view const& v) const
+    {
+        return ::tip::db::pg::hash_value(v);
+    }
+};
+
+}  // namespace std
+
+#endif /* TIP_DB_PG_FIELD_VIEW_HPP_ */
@@ -9,12 +9,40 @@
 #define LIB_PG_ASYNC_INCLUDE_TIP_DB_PG_IO_BYTEA_HPP_
 
 #include <tip/db/pg/protocol_io_traits.hpp>
+#include <tip/db/pg/detail/protocol_parsers.hpp>
+
+#include <string>
+#include <vector>
 
 namespace tip {
 namespace db {
 namespace pg {
 namespace io {
 
+namespace detail {
+
+/**
+ * @brief Metafunction to check if an iterator points to a contiguous char
+ * 		buffer, so that the input can be decoded as a whole.
+ */
+template < typename InputIterator >
+struct is_contiguous_char_iterator : std::false_type {};
+
+template <>
+struct is_contiguous_char_iterator< char* > : std::true_type {};
+template <>
+struct is_contiguous_char_iterator< char const* > : std::true_type {};
+template <>
+struct is_contiguous_char_iterator< std::vector<char>::iterator > : std::true_type {};
+template <>
+struct is_contiguous_char_iterator< std::vector<char>::const_iterator > : std::true_type {};
+template <>
+struct is_contiguous_char_iterator< std::string::iterator > : std::true_type {};
+template <>
+struct is_contiguous_char_iterator< std::string::const_iterator > : std::true_type {};
+
+}  // namespace detail
+
 /**
  * @brief Protocol parser specialization for bytea (binary string), text data format
  */
@@ -41,6 +69,13 @@ struct protocol_parser< bytea, TEXT_DATA_FORMAT > :
 	template < typename InputIterator >
 	InputIterator
 	operator()( InputIterator begin, InputIterator end );
+private:
+	template < typename InputIterator >
+	InputIterator
+	parse(InputIterator begin, InputIterator end, std::true_type const&);
+	template < typename InputIterator >
+	InputIterator
+	parse(InputIterator begin, InputIterator end, std::false_type const&);
 };
 
 /**
@@ -121,6 +156,37 @@ protocol_parser< bytea, TEXT_DATA_FORMAT >::operator ()
 	typedef typename iter_traits::value_type iter_value_type;
 	static_assert(std::is_same< iter_value_type, byte >::type::value,
 			"Input iterator must be over a char container");
+	return parse(begin, end,
+			detail::is_contiguous_char_iterator< iterator_type >{});
+}
+
+template < typename InputIterator >
+InputIterator
+protocol_parser< bytea, TEXT_DATA_FORMAT >::parse(
+		InputIterator begin, InputIterator end, std::true_type const&)
+{
+	if (begin == end) {
+		base_type::value.clear();
+		return end;
+	}
+	std::vector<byte> data;
+	char const* b = &*begin;
+	if (detail::decode_bytea(b, b + (end - begin), data)) {
+		base_type::value.swap(data);
+		return end;
+	}
+	return begin;
+}
+
+template < typename InputIterator >
+InputIterator
+protocol_parser< bytea, TEXT_DATA_FORMAT >::parse(
+		InputIterator begin, InputIterator end, std::false_type const&)
+{
+	if (begin == end) {
+		base_type::value.clear();
+		return end;
+	}
 	std::vector<byte> data;
 
 	auto result = detail::bytea_parser().parse(begin, end, std::back_inserter(data));
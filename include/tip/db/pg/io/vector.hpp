@@ -10,6 +10,7 @@
 
 #include <tip/db/pg/protocol_io_traits.hpp>
 #include <tip/db/pg/io/container_to_array.hpp>
+#include <tip/util/endian.hpp>
 
 #include <vector>
 
@@ -59,12 +60,122 @@ struct protocol_parser< std::vector< T >, TEXT_DATA_FORMAT > :
 	}
 };
 
+namespace detail {
+
+/**
+ * @brief Parser for one-dimensional PostgreSQL array of fixed-size integral
+ * 		values in binary format.
+ *
+ * Element payloads are gathered into the vector storage and then converted
+ * from network byte order in one pass.
+ * Arrays containing NULLs or more than one dimension are rejected, as are
+ * arrays of another element type, e.g. float4[] or oid[] for int4, which
+ * have the same element size.
+ * @tparam ElemOid type oid of the array elements
+ */
+template < typename T, oids::type::oid_type ElemOid >
+struct binary_integral_array_parser : detail::parser_base< std::vector< T > > {
+	typedef detail::parser_base< std::vector< T > > base_type;
+	typedef typename base_type::value_type value_type;
+
+	binary_integral_array_parser(value_type& v) : base_type(v) {}
+
+	template < typename InputIterator >
+	InputIterator
+	operator()(InputIterator begin, InputIterator end)
+	{
+		typedef std::iterator_traits< InputIterator > iter_traits;
+		typedef typename iter_traits::value_type iter_value_type;
+		static_assert(std::is_same< iter_value_type, byte >::type::value,
+				"Input iterator must be over a char container");
+
+		InputIterator p = begin;
+		integer ndim(0), flags(0), elem_oid(0);
+		if (!read_int(p, end, ndim) || !read_int(p, end, flags)
+				|| !read_int(p, end, elem_oid))
+			return begin;
+		if (elem_oid != ElemOid)
+			return begin;
+		if (ndim == 0) {
+			base_type::value.clear();
+			return p;
+		}
+		integer count(0), lbound(0);
+		if (ndim != 1 || !read_int(p, end, count) || !read_int(p, end, lbound)
+				|| count < 0)
+			return begin;
+		size_t const elem_size = sizeof(integer) + sizeof(T);
+		if (static_cast<size_t>(end - p) < elem_size * count)
+			return begin;
+
+		value_type tmp(count);
+		char* out = reinterpret_cast<char*>(tmp.data());
+		for (integer i = 0; i < count; ++i, out += sizeof(T)) {
+			integer len(0);
+			read_int(p, end, len);
+			if (len != sizeof(T))
+				return begin;
+			std::copy(p, p + sizeof(T), out);
+			p += sizeof(T);
+		}
+		util::endian::big_to_native(tmp.data(), tmp.data(), tmp.size());
+		base_type::value.swap(tmp);
+		return p;
+	}
+private:
+	template < typename InputIterator >
+	static bool
+	read_int(InputIterator& p, InputIterator end, integer& val)
+	{
+		InputIterator c = protocol_read< BINARY_DATA_FORMAT >(p, end, val);
+		if (c == p)
+			return false;
+		p = c;
+		return true;
+	}
+};
+
+}  // namespace detail
+
+template <>
+struct protocol_parser< std::vector< smallint >, BINARY_DATA_FORMAT > :
+		detail::binary_integral_array_parser< smallint, oids::type::int2 > {
+	typedef detail::binary_integral_array_parser< smallint, oids::type::int2 > base_type;
+	typedef base_type::value_type value_type;
+
+	protocol_parser(value_type& v) : base_type(v) {}
+};
+
+template <>
+struct protocol_parser< std::vector< integer >, BINARY_DATA_FORMAT > :
+		detail::binary_integral_array_parser< integer, oids::type::int4 > {
+	typedef detail::binary_integral_array_parser< integer, oids::type::int4 > base_type;
+	typedef base_type::value_type value_type;
+
+	protocol_parser(value_type& v) : base_type(v) {}
+};
+
+template <>
+struct protocol_parser< std::vector< bigint >, BINARY_DATA_FORMAT > :
+		detail::binary_integral_array_parser< bigint, oids::type::int8 > {
+	typedef detail::binary_integral_array_parser< bigint, oids::type::int8 > base_type;
+	typedef base_type::value_type value_type;
+
+	protocol_parser(value_type& v) : base_type(v) {}
+};
+
 namespace traits {
 
 template < typename T >
 struct has_formatter< std::vector< T >, TEXT_DATA_FORMAT > : std::true_type {};
 template < typename T >
 struct has_parser< std::vector< T >, TEXT_DATA_FORMAT > : std::true_type {};
+template <>
+struct has_parser< std::vector< smallint >, BINARY_DATA_FORMAT > : std::true_type {};
+template <>
+struct has_parser< std::vector< integer >, BINARY_DATA_FORMAT > : std::true_type {};
+template <>
+struct has_parser< std::vector< bigint >, BINARY_DATA_FORMAT > : std::true_type {};
 
 template < typename T >
 struct cpppg_data_mapping< std::vector< T > > :
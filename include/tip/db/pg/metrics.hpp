@@ -0,0 +1,134 @@
+/**
+ *  @file tip/db/pg/metrics.hpp
+ *
+ *  @date Oct 18, 2026
+ *  @author: zmij
+ */
+
+#ifndef TIP_DB_PG_METRICS_HPP_
+#define TIP_DB_PG_METRICS_HPP_
+
+#include <tip/db/pg/common.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace tip {
+namespace db {
+namespace pg {
+
+/**
+ * @brief Latency histogram with exponential buckets.
+ *
+ * Bucket `i` counts the values less than `upper_bound(i)`, that is
+ * 2^i microseconds, and not less than the upper bound of the previous
+ * bucket. The last bucket counts all values that didn't fit the others.
+ */
+struct latency_histogram {
+    using duration          = ::std::chrono::microseconds;
+    using counter_type      = ::std::uint64_t;
+    static constexpr ::std::size_t bucket_count = 24;
+    using buckets_type      = ::std::array< counter_type, bucket_count >;
+
+    buckets_type    buckets;
+    counter_type    count   = 0;    /**< Number of values recorded */
+    duration        sum     = duration::zero(); /**< Sum of values recorded */
+    duration        max     = duration::zero(); /**< Maximum value recorded */
+
+    latency_histogram() { buckets.fill(0); }
+
+    /** Upper bound of the bucket, the last one is unbounded */
+    static duration
+    upper_bound(::std::size_t bucket)
+    { return duration{ duration::rep{1} << bucket }; }
+
+    /** Index of the bucket for a value */
+    static ::std::size_t
+    bucket_of(duration val);
+
+    /**
+     * Approximate value at the quantile, the upper bound of the bucket
+     * containing it.
+     * @param q quantile in range [0, 1]
+     */
+    duration
+    quantile(double q) const;
+};
+
+/**
+ * @brief Counters of a single database connection
+ */
+struct connection_metrics {
+    using counter_type      = ::std::uint64_t;
+
+    ::std::size_t   number      = 0;    /**< Connection number, as in logs */
+    bool            busy        = false;/**< Connection is in a transaction */
+    counter_type    queries     = 0;    /**< Queries executed */
+    counter_type    errors      = 0;    /**< Error responses from the server */
+    counter_type    bytes_in    = 0;    /**< Bytes received */
+    counter_type    bytes_out   = 0;    /**< Bytes sent */
+    counter_type    reads       = 0;    /**< Socket reads */
+    counter_type    full_reads  = 0;    /**< Reads that filled the read buffer */
+    ::std::size_t   read_size   = 0;    /**< Current size of the read buffer */
+};
+
+/**
+ * @brief Snapshot of a connection pool state and counters.
+ *
+ * The counters are cumulative since the pool creation.
+ * @see db_service::metrics
+ */
+struct pool_metrics {
+    using counter_type      = ::std::uint64_t;
+    using duration          = ::std::chrono::milliseconds;
+    using connections_type  = ::std::vector< connection_metrics >;
+
+    dbalias         alias;
+    ::std::string   uri;                     /**< Host of the pool */
+    host_role       role                = host_role::primary;
+    ::std::size_t   shard               = 0; /**< Shard owning the pool */
+    duration        uptime              = duration::zero();
+
+    //@{
+    /** @name Pool state */
+    ::std::size_t   max_size            = 0;
+    ::std::size_t   idle                = 0; /**< Idle connections */
+    ::std::size_t   busy                = 0; /**< Connections running transactions */
+    ::std::size_t   connecting          = 0; /**< Connections being established */
+    ::std::size_t   queue_depth         = 0; /**< Requests waiting for a connection */
+    //@}
+
+    //@{
+    /** @name Counters */
+    counter_type    acquired            = 0; /**< Connections handed to requests */
+    counter_type    connections_created = 0;
+    counter_type    connections_closed  = 0;
+    counter_type    connection_errors   = 0;
+    //@}
+
+    /** Time requests waited for a connection */
+    latency_histogram   acquire_wait;
+
+    /** Counters of the connections currently in the pool */
+    connections_type    connections;
+
+    /** Connections created per second, averaged over the uptime */
+    double
+    creation_rate() const;
+};
+
+::std::ostream&
+operator << (::std::ostream&, latency_histogram const&);
+::std::ostream&
+operator << (::std::ostream&, connection_metrics const&);
+::std::ostream&
+operator << (::std::ostream&, pool_metrics const&);
+
+}  // namespace pg
+}  // namespace db
+}  // namespace tip
+
+#endif /* TIP_DB_PG_METRICS_HPP_ */
@@ -38,13 +38,11 @@ binary_data_parser<T, INTEGRAL>::operator()(InputIterator begin, InputIterator e
 	assert( (end - begin) >= (decltype (end - begin))size() && "Buffer size is insufficient" );
 	value_type tmp(0);
 	char* p = reinterpret_cast<char*>(&tmp);
-	char* e = p + size();
-	while (p != e && begin != end) {
-		*p++ = *begin++;
-	}
+	InputIterator e = begin + std::min< decltype(end - begin) >(end - begin, size());
+	std::copy(begin, e, p);
 	tmp = util::endian::big_to_native(tmp);
 	std::swap( base_type::value, tmp );
-	return begin;
+	return e;
 }
 
 template < typename T >
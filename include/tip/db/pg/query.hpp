@@ -139,6 +139,40 @@ public:
      */
     query&
     bind();
+
+    /**
+     * @brief Set the query deadline.
+     *
+     * When the deadline expires, the query is cancelled on the server and
+     * the error callback receives error::query_timeout. The connection
+     * stays in the pool.
+     * @param timeout zero means no deadline
+     */
+    query&
+    timeout(transaction_mode::duration timeout);
+    /**
+     * @brief Run the query without a transaction wrapper.
+     *
+     * The statement goes to an idle connection without BEGIN and COMMIT,
+     * and the connection returns to the pool as soon as the statement
+     * completes. Calling commit on the transaction passed to the result
+     * callback is not needed. Has no effect on a query constructed with
+     * a transaction.
+     * @see transaction_mode::autocommit
+     */
+    query&
+    autocommit(bool value = true);
+    /**
+     * @brief Commit the transaction right after the query.
+     *
+     * COMMIT is sent in the same write as the query, so a transaction
+     * with a single statement takes one round trip to the server. The
+     * transaction passed to the result callback cannot be used for other
+     * queries and doesn't need to be committed.
+     * @see transaction::execute
+     */
+    query&
+    commit_after(bool value = true);
     /**
      * @brief Start running the query
      * @pre If a query was constructed with an alias - the database connection
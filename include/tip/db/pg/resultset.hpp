@@ -12,12 +12,15 @@
 #include <tip/db/pg/common.hpp>
 #include <tip/db/pg/error.hpp>
 #include <tip/db/pg/protocol_io_traits.hpp>
+#include <tip/db/pg/field_view.hpp>
 #include <tip/db/pg/detail/data_iterator.hpp>
 
+#include <initializer_list>
 #include <iterator>
 #include <istream>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 namespace tip {
 namespace db {
@@ -185,6 +188,81 @@ public:
     }
     //@}
 public:
+    /**
+     * Column indexes for a list of field names, resolved once per result set
+     * and cached in it. Use it to extract fields by name in a loop over rows
+     * without looking the names up for each row.
+     * Shares the resolved indexes with the cache, copying it is cheap.
+     * The indexes are only meaningful for the parent result set.
+     * @code
+     * resultset::column_binding cols = res.bind({ "id", "name" });
+     * for (resultset::row const& row : res) {
+     *     int id;
+     *     std::string name;
+     *     row.to(cols, id, name);
+     * }
+     * @endcode
+     */
+    class column_binding {
+    public:
+        typedef std::vector< usmallint > index_list;
+        /** Number of bound columns */
+        std::size_t
+        size() const
+        { return indexes_->size(); }
+        /** Index of the n-th bound column in the row */
+        usmallint
+        operator[](std::size_t n) const
+        { return (*indexes_)[n]; }
+    private:
+        friend class resultset;
+        typedef ::std::shared_ptr< index_list const > index_list_ptr;
+        explicit
+        column_binding(index_list_ptr indexes) : indexes_(indexes) {}
+
+        index_list_ptr indexes_;
+    };
+
+    template < typename ... T >
+    class typed_range;
+
+    /**
+     * Get a range over the rows of the result set, that yields the first
+     * sizeof...(T) fields of each row as a tuple of typed values.
+     * The parser for each column is selected once when the range is
+     * created, not for every field.
+     * @code
+     * for (auto const& t : res.as< int, std::string >()) {
+     *     std::cout << std::get<0>(t) << " " << std::get<1>(t) << "\n";
+     * }
+     * @endcode
+     * @tparam T types of fields
+     * @throws db_error if the result set has less columns than requested
+     *         or a column is in binary format and the type has no binary parser
+     */
+    template < typename ... T >
+    typed_range< T ... >
+    as() const;
+    /**
+     * Get a range over the rows of the result set, that yields the fields
+     * bound by name as a tuple of typed values. The names are resolved
+     * once for the range.
+     * @code
+     * for (auto const& t : res.as< int, std::string >({ "id", "name" })) {
+     *     std::cout << std::get<0>(t) << " " << std::get<1>(t) << "\n";
+     * }
+     * @endcode
+     * @tparam T types of fields
+     * @param cols column binding obtained from the result set
+     * @throws db_error if less columns than requested are bound
+     *         or a column is in binary format and the type has no binary parser
+     */
+    template < typename ... T >
+    typed_range< T ... >
+    as(column_binding const& cols) const;
+    template < typename ... T >
+    typed_range< T ... >
+    as(::std::initializer_list<::std::string> const& names) const;
     //@{
     /** @name Data access classes */
     /**
@@ -282,6 +360,25 @@ public:
         to(::std::initializer_list<::std::string> const& names,
                 T& ... val) const;
 
+        /**
+         * Get fields bound by name as a tuple of typed values.
+         * @param cols column binding obtained from the result set
+         */
+        template < typename ... T >
+        void
+        to(column_binding cols, ::std::tuple< T ... >&) const;
+        template < typename ... T >
+        void
+        to(column_binding cols, T& ... val) const;
+
+        /**
+         * Resolve field names to indexes.
+         * Shortcut to the resultset's method
+         */
+        column_binding
+        bind(::std::initializer_list<::std::string> const& names) const
+        { return result_->bind(names); }
+
         /**
          * Get the index of field with name.
          * Shortcut to the resultset's method
@@ -372,6 +469,34 @@ public:
             return false;
         }
 
+        /**
+         * Get a view of the raw field data without copying it.
+         * The view shares ownership of the result set data.
+         * @return view of the field data, is_null() is set for null values
+         */
+        field_view
+        view() const;
+
+        /**
+         * Get a view of the raw field data, enables `as<field_view>()`.
+         * Null values don't throw, the view is marked as null instead.
+         * @param val Target view.
+         * @return always true
+         */
+        bool
+        to( field_view& val ) const;
+
+        /**
+         * Get a non-owning reference to the raw field data, enables
+         * `as<boost::string_ref>()`. The reference is valid while the
+         * result set data is alive.
+         * @param val Target reference.
+         * @return always true
+         * @exception tip::db::pg::value_is_null
+         */
+        bool
+        to( boost::string_ref& val ) const;
+
         /**
          * Cast the field value to the type requested.
          * @tparam T requested data type
@@ -540,6 +665,18 @@ public:
     size_type
     index_of_name(std::string const& name) const;
 
+    /**
+     * Resolve a list of field names to column indexes. The resolution is
+     * cached in the result set, so binding the same names again is cheap.
+     * @param names field names
+     * @return column binding to use in row data extraction
+     * @throws db_error if there is no field with one of the names
+     */
+    column_binding
+    bind(std::initializer_list<std::string> const& names) const;
+    column_binding
+    bind(std::vector<std::string> const& names) const;
+
     /**
      * Get the field description of field by it's index.
      * @param col_index field index, must be in range of [0..columns_size)
@@ -578,6 +715,18 @@ private:
 
     bool
     is_null(size_type r, row::size_type c) const;
+
+    field_view
+    view(size_type r, row::size_type c) const;
+
+    typedef field_buffer::const_iterator const_data_iterator;
+    /**
+     * Get the field data bounds
+     * @return true if the field is null
+     */
+    bool
+    field_data(size_type r, row::size_type c,
+            const_data_iterator& begin, const_data_iterator& end) const;
 }; // resultset
 
 inline resultset::row::difference_type
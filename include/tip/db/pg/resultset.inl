@@ -11,6 +11,8 @@
 #include <tip/db/pg/resultset.hpp>
 #include <tip/util/meta_helpers.hpp>
 
+#include <array>
+
 namespace tip {
 namespace db {
 namespace pg {
@@ -75,6 +77,7 @@ struct field_by_name_extractor;
 template < ::std::size_t ... Indexes, typename ... T >
 struct field_by_name_extractor< util::indexes_tuple<Indexes ...>, T... > {
     static constexpr ::std::size_t size = sizeof ... (T);
+    typedef ::std::array< resultset::row::size_type, size > column_indexes;
 
     static void
     get_tuple( resultset::row const& row,
@@ -83,8 +86,7 @@ struct field_by_name_extractor< util::indexes_tuple<Indexes ...>, T... > {
     {
         if (names.size() < size)
             throw error::db_error{"Not enough names in row data extraction"};
-        ::std::tuple<T ... > tmp( row[*(names.begin() + Indexes)].template as<T>()... );
-        tmp.swap(val);
+        get_tuple(row, resolve(row, names), val);
     }
 
     static void
@@ -92,7 +94,71 @@ struct field_by_name_extractor< util::indexes_tuple<Indexes ...>, T... > {
             ::std::initializer_list<::std::string> const& names,
             T&... val)
     {
-        util::expand{ row[*(names.begin() + Indexes)].to(val)... };
+        if (names.size() < size)
+            throw error::db_error{"Not enough names in row data extraction"};
+        get_values(row, resolve(row, names), val...);
+    }
+
+    static void
+    get_tuple( resultset::row const& row,
+            resultset::column_binding const& cols,
+            ::std::tuple< T... >& val )
+    {
+        if (cols.size() < size)
+            throw error::db_error{"Not enough columns in row data extraction"};
+        get_tuple(row, bound(cols), val);
+    }
+
+    static void
+    get_values(resultset::row const& row,
+            resultset::column_binding const& cols,
+            T&... val)
+    {
+        if (cols.size() < size)
+            throw error::db_error{"Not enough columns in row data extraction"};
+        get_values(row, bound(cols), val...);
+    }
+private:
+    static column_indexes
+    bound(resultset::column_binding const& cols)
+    {
+        return column_indexes{{
+            static_cast< resultset::row::size_type >(cols[Indexes])... }};
+    }
+
+    /**
+     * Resolve the names for a single row via the result's name index,
+     * without touching the cache of bindings.
+     */
+    static column_indexes
+    resolve(resultset::row const& row,
+            ::std::initializer_list<::std::string> const& names)
+    {
+        return column_indexes{{ index_of(row, *(names.begin() + Indexes))... }};
+    }
+
+    static resultset::row::size_type
+    index_of(resultset::row const& row, ::std::string const& name)
+    {
+        resultset::size_type idx = row.index_of_name(name);
+        if (idx == resultset::npos)
+            throw error::db_error{"No field with name " + name};
+        return static_cast< resultset::row::size_type >(idx);
+    }
+
+    static void
+    get_tuple( resultset::row const& row, column_indexes const& cols,
+            ::std::tuple< T... >& val )
+    {
+        ::std::tuple<T ... > tmp( row[cols[Indexes]].template as<T>()... );
+        tmp.swap(val);
+    }
+
+    static void
+    get_values(resultset::row const& row, column_indexes const& cols,
+            T&... val)
+    {
+        util::expand{ row[cols[Indexes]].to(val)... };
     }
 };
 
@@ -100,8 +166,265 @@ template < typename ... T >
 struct row_data_by_name_extractor
     : field_by_name_extractor< typename util::index_builder< sizeof ... (T) >::type, T ... > {};
 
+/**
+ * Column reader for a typed row range. The parser for the column data
+ * format is selected on construction.
+ */
+template < typename T >
+struct typed_column {
+    typedef typename ::std::decay< T >::type value_type;
+    typedef field_buffer::const_iterator const_iterator;
+    typedef void (*parser_function)(const_iterator, const_iterator, value_type&);
+
+    typed_column() : parse_(nullptr), name_(nullptr) {}
+    typed_column(field_description const& fd)
+        : parse_(select(fd, io::traits::has_parser<value_type, BINARY_DATA_FORMAT>())),
+          name_(&fd.name)
+    {
+    }
+
+    void
+    read(const_iterator begin, const_iterator end, bool null, value_type& val) const
+    {
+        if (null) {
+            set_null(val, io::traits::is_nullable< value_type >());
+        } else {
+            parse_(begin, end, val);
+        }
+    }
+private:
+    template < protocol_data_format F >
+    static void
+    parse(const_iterator begin, const_iterator end, value_type& val)
+    {
+        io::protocol_read< F >(begin, end, val);
+    }
+
+    static parser_function
+    select(field_description const& fd, ::std::true_type const&)
+    {
+        if (fd.format_code == BINARY_DATA_FORMAT)
+            return &parse< BINARY_DATA_FORMAT >;
+        return &parse< TEXT_DATA_FORMAT >;
+    }
+    static parser_function
+    select(field_description const& fd, ::std::false_type const&)
+    {
+        if (fd.format_code == BINARY_DATA_FORMAT) {
+            throw error::db_error{"Cannot find BINARY_DATA_FORMAT parser for field " + fd.name};
+        }
+        return &parse< TEXT_DATA_FORMAT >;
+    }
+
+    void
+    set_null(value_type& val, ::std::true_type const&) const
+    {
+        io::traits::nullable_traits< value_type >::set_null(val);
+    }
+    void
+    set_null(value_type&, ::std::false_type const&) const
+    {
+        throw error::value_is_null(*name_);
+    }
+
+    parser_function parse_;
+    ::std::string const* name_;
+};
+
+template < typename T >
+struct typed_column< ::boost::optional< T > > {
+    typedef ::boost::optional< T > value_type;
+    typedef field_buffer::const_iterator const_iterator;
+
+    typed_column() : column_() {}
+    typed_column(field_description const& fd) : column_(fd) {}
+
+    void
+    read(const_iterator begin, const_iterator end, bool null, value_type& val) const
+    {
+        if (null) {
+            value_type().swap(val);
+        } else {
+            typename typed_column< T >::value_type tmp;
+            column_.read(begin, end, false, tmp);
+            val = tmp;
+        }
+    }
+private:
+    typed_column< T > column_;
+};
+
 }  // namespace detail
 
+/**
+ * Range over rows of a result set yielding tuples of typed values.
+ * Columns are taken by position or by a column binding, which is resolved
+ * once for the range.
+ * Holds a copy of the result set, iterators must not outlive the range.
+ */
+template < typename ... T >
+class resultset::typed_range {
+public:
+    typedef ::std::tuple< typename ::std::decay< T >::type ... > value_type;
+    typedef resultset::size_type size_type;
+
+    class const_iterator
+        : public ::std::iterator< ::std::forward_iterator_tag, value_type,
+                resultset::difference_type, value_type const*, value_type > {
+    public:
+        const_iterator() : range_(nullptr), row_(0) {}
+
+        value_type
+        operator*() const
+        {
+            value_type val;
+            range_->read_row(row_, val, indexes_type());
+            return val;
+        }
+
+        const_iterator&
+        operator++()
+        {
+            ++row_;
+            return *this;
+        }
+        const_iterator
+        operator++(int)
+        {
+            const_iterator prev(*this);
+            ++row_;
+            return prev;
+        }
+
+        bool
+        operator == (const_iterator const& rhs) const
+        { return range_ == rhs.range_ && row_ == rhs.row_; }
+        bool
+        operator != (const_iterator const& rhs) const
+        { return !(*this == rhs); }
+    private:
+        friend class typed_range;
+        const_iterator(typed_range const* range, size_type row)
+            : range_(range), row_(row) {}
+
+        typed_range const* range_;
+        size_type row_;
+    };
+    typedef const_iterator iterator;
+public:
+    explicit
+    typed_range(resultset const& res)
+        : result_(res), indexes_(positions(indexes_type())), columns_()
+    {
+        if (!result_.empty()) {
+            if (result_.columns_size() < static_cast<row::size_type>(sizeof ... (T)))
+                throw error::db_error{"Not enough columns in row data extraction"};
+            select_columns(indexes_type());
+        }
+    }
+    typed_range(resultset const& res, column_binding const& cols)
+        : result_(res), indexes_(), columns_()
+    {
+        if (cols.size() < sizeof ... (T))
+            throw error::db_error{"Not enough columns in row data extraction"};
+        indexes_ = bound(cols, indexes_type());
+        if (!result_.empty()) {
+            select_columns(indexes_type());
+        }
+    }
+
+    size_type
+    size() const
+    { return result_.size(); }
+    bool
+    empty() const
+    { return result_.empty(); }
+
+    const_iterator
+    begin() const
+    { return const_iterator(this, 0); }
+    const_iterator
+    end() const
+    { return const_iterator(this, size()); }
+
+    /**
+     * Get the values of a row
+     * @param index row index
+     * @return tuple of typed values
+     */
+    value_type
+    operator[](size_type index) const
+    { return *const_iterator(this, index); }
+private:
+    typedef typename util::index_builder< sizeof ... (T) >::type indexes_type;
+    typedef ::std::array< row::size_type, sizeof ... (T) > column_indexes;
+    typedef ::std::tuple< detail::typed_column< T > ... > columns_type;
+
+    template < ::std::size_t ... Indexes >
+    static column_indexes
+    positions(util::indexes_tuple< Indexes ... > const&)
+    {
+        return column_indexes{{ static_cast< row::size_type >(Indexes)... }};
+    }
+
+    template < ::std::size_t ... Indexes >
+    static column_indexes
+    bound(column_binding const& cols, util::indexes_tuple< Indexes ... > const&)
+    {
+        return column_indexes{{ static_cast< row::size_type >(cols[Indexes])... }};
+    }
+
+    template < ::std::size_t ... Indexes >
+    void
+    select_columns(util::indexes_tuple< Indexes ... > const&)
+    {
+        columns_ = columns_type(
+                detail::typed_column< T >(result_.field(indexes_[Indexes])) ... );
+    }
+
+    template < ::std::size_t N >
+    bool
+    read_field(size_type row, value_type& val) const
+    {
+        const_data_iterator b, e;
+        bool null = result_.field_data(row, ::std::get< N >(indexes_), b, e);
+        ::std::get< N >(columns_).read(b, e, null, ::std::get< N >(val));
+        return true;
+    }
+
+    template < ::std::size_t ... Indexes >
+    void
+    read_row(size_type row, value_type& val, util::indexes_tuple< Indexes ... > const&) const
+    {
+        util::expand{ read_field< Indexes >(row, val) ... };
+    }
+
+    resultset result_;
+    column_indexes indexes_;
+    columns_type columns_;
+};
+
+template < typename ... T >
+resultset::typed_range< T ... >
+resultset::as() const
+{
+    return typed_range< T ... >(*this);
+}
+
+template < typename ... T >
+resultset::typed_range< T ... >
+resultset::as(column_binding const& cols) const
+{
+    return typed_range< T ... >(*this, cols);
+}
+
+template < typename ... T >
+resultset::typed_range< T ... >
+resultset::as(::std::initializer_list<::std::string> const& names) const
+{
+    return typed_range< T ... >(*this, bind(names));
+}
+
 template < typename ... T >
 void
 resultset::row::to(std::tuple< T ... >& val) const
@@ -151,6 +474,20 @@ resultset::row::to(::std::initializer_list<::std::string> const& names,
     detail::row_data_by_name_extractor<T...>::get_values(*this, names, val...);
 }
 
+template < typename ... T >
+void
+resultset::row::to(column_binding cols, ::std::tuple<T ...>& val) const
+{
+    detail::row_data_by_name_extractor<T...>::get_tuple(*this, cols, val);
+}
+
+template < typename ... T >
+void
+resultset::row::to(column_binding cols, T& ... val) const
+{
+    detail::row_data_by_name_extractor<T...>::get_values(*this, cols, val...);
+}
+
 }  // namespace pg
 }  // namespace db
 }  // namespace tip
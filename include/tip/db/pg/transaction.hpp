@@ -41,8 +41,9 @@ public:
 
     using notification_callback = ::std::function< void() >;
     using atomic_flag           = ::std::atomic_flag;
+    using duration              = transaction_mode::duration;
 public:
-    transaction(connection_ptr);
+    transaction(connection_ptr, bool autocommit = false);
     ~transaction();
 
     transaction(transaction const&) = delete;
@@ -83,6 +84,16 @@ public:
     bool
     in_transaction() const;
 
+    /**
+     * The transaction runs a single statement in autocommit mode.
+     * After the statement is executed, commit only calls the callback and
+     * rollback fails, the connection is already back in the pool.
+     * @see transaction_mode::autocommit
+     */
+    bool
+    autocommit() const
+    { return autocommit_; }
+
     void
     commit_async(notification_callback = notification_callback(),
             error_callback = error_callback());
@@ -139,25 +150,66 @@ public:
         future.get();
     }
 
+    /**
+     * Execute a query
+     * @param timeout query deadline, when it expires the query is cancelled
+     *         on the server and the error callback receives
+     *         error::query_timeout. Zero means no deadline.
+     * @param commit_after send COMMIT in the same write as the query.
+     *         The server commits the transaction if the query succeeds and
+     *         rolls it back otherwise, the transaction cannot be used after
+     *         the query and there is no need to commit it. An error raised
+     *         on the client side, e.g. in the result callback, cannot roll
+     *         the transaction back. Ignored in autocommit mode.
+     */
     void
     execute(std::string const& query, query_result_callback,
-            query_error_callback);
+            query_error_callback, duration timeout = duration::zero(),
+            bool commit_after = false);
     void
     execute(std::string const& query, type_oid_sequence const& param_types,
             std::vector< byte > params_buffer,
-            query_result_callback, query_error_callback);
+            query_result_callback, query_error_callback,
+            duration timeout = duration::zero(),
+            bool commit_after = false);
 private:
     template < typename Mutex, typename TransportType, typename SharedType >
     friend struct detail::connection_fsm_def;
+    struct deadline;
+    using deadline_ptr = ::std::shared_ptr<deadline>;
+
+    void
+    mark_done();
     void
-    mark_done()
-    { finished_.test_and_set(); }
+    start_deadline(duration timeout);
+    deadline_ptr
+    query_deadline(duration timeout);
+    /**
+     * Stop the query deadline
+     * @return true if the transaction deadline has expired
+     */
+    bool
+    query_finished(deadline_ptr);
     void
-    handle_results(resultset, bool, query_result_callback);
+    handle_results(resultset, bool, query_result_callback, deadline_ptr);
     void
-    handle_query_error(error::query_error const&, query_error_callback);
+    handle_query_error(error::query_error const&, query_error_callback,
+            deadline_ptr);
+    /**
+     * Autocommit statement was sent, the connection must not be used
+     * by the transaction anymore
+     */
+    bool
+    statement_sent() const
+    { return autocommit_ && executed_.load(); }
+    bool
+    send_statement(query_error_callback const&);
+
     connection_ptr  connection_;
     atomic_flag     finished_;
+    deadline_ptr    deadline_;
+    bool const      autocommit_;
+    ::std::atomic<bool> executed_;
 };
 
 } /* namespace pg */
@@ -9,10 +9,13 @@
 #define LIB_PG_ASYNC_INCLUDE_TIP_UTIL_ENDIAN_HPP_
 
 #include <boost/predef/other/endian.h>
-#include <boost/predef/detail/endian_compat.h>
 #include <boost/cstdint.hpp>
 #include <boost/endian/detail/intrinsic.hpp>
 #include <type_traits>
+#include <cstddef>
+#include <cstring>
+
+#include <tip/util/simd.hpp>
 
 namespace tip {
 namespace util {
@@ -20,7 +23,7 @@ namespace endian {
 
 enum order {
 	big, little,
-#ifdef BOOST_BIG_ENDIAN
+#if BOOST_ENDIAN_BIG_BYTE
 	native = big
 #else
 	nagive = little
@@ -152,7 +155,7 @@ template < typename T >
 inline T
 big_to_native(T x)
 {
-#ifdef BOOST_BIG_ENDIAN
+#if BOOST_ENDIAN_BIG_BYTE
 	return x;
 #else
 	return endian_reverse(x);
@@ -163,7 +166,7 @@ template < typename T >
 inline T
 native_to_big(T x)
 {
-#ifdef BOOST_BIG_ENDIAN
+#if BOOST_ENDIAN_BIG_BYTE
 	return x;
 #else
 	return endian_reverse(x);
@@ -174,7 +177,7 @@ template < typename T >
 inline T
 little_to_native(T x)
 {
-#ifdef BOOST_LITTLE_ENDIAN
+#if BOOST_ENDIAN_LITTLE_BYTE
 	return x;
 #else
 	return endian_reverse(x);
@@ -185,13 +188,171 @@ template < typename T >
 inline T
 native_to_little(T x)
 {
-#ifdef BOOST_LITTLE_ENDIAN
+#if BOOST_ENDIAN_LITTLE_BYTE
 	return x;
 #else
 	return endian_reverse(x);
 #endif
 }
 
+//@{
+/** @name Bulk conversion */
+namespace detail {
+
+/**
+ * Reverse byte order of n values of Size bytes each, one value at a time.
+ * Source and destination may be unaligned and may be the same buffer.
+ */
+template < size_t Size >
+inline void
+bulk_reverse_scalar(char const* src, char* dst, size_t n)
+{
+	typedef typename std::conditional< Size == sizeof(uint16_t), uint16_t,
+		typename std::conditional< Size == sizeof(uint32_t), uint32_t,
+			uint64_t >::type >::type value_type;
+	for (size_t i = 0; i < n; ++i, src += Size, dst += Size) {
+		value_type tmp;
+		std::memcpy(&tmp, src, Size);
+		tmp = endian_reverse(tmp);
+		std::memcpy(dst, &tmp, Size);
+	}
+}
+
+#ifdef TIP_UTIL_X86_SIMD
+/**
+ * Byte shuffle mask reversing each Size-byte lane of a 16-byte block
+ * @param size size of a single value
+ * @param mask 16 bytes of output
+ */
+inline void
+bulk_reverse_mask(size_t size, char* mask)
+{
+	for (size_t i = 0; i < 16; ++i) {
+		mask[i] = static_cast<char>(i - i % size + (size - 1 - i % size));
+	}
+}
+
+template < size_t Size >
+__attribute__((target("ssse3")))
+inline void
+bulk_reverse_ssse3(char const* src, char* dst, size_t n)
+{
+	char m[16];
+	bulk_reverse_mask(Size, m);
+	__m128i const mask = _mm_loadu_si128(reinterpret_cast<__m128i const*>(m));
+	size_t const per_block = 16 / Size;
+	size_t i = 0;
+	for (; i + per_block <= n; i += per_block, src += 16, dst += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(v, mask));
+	}
+	bulk_reverse_scalar<Size>(src, dst, n - i);
+}
+
+template < size_t Size >
+__attribute__((target("avx2")))
+inline void
+bulk_reverse_avx2(char const* src, char* dst, size_t n)
+{
+	char m[32];
+	bulk_reverse_mask(Size, m);
+	bulk_reverse_mask(Size, m + 16);
+	// _mm256_shuffle_epi8 shuffles within 128-bit lanes, lanes never split a value
+	__m256i const mask = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(m));
+	size_t const per_block = 32 / Size;
+	size_t i = 0;
+	for (; i + per_block * 2 <= n; i += per_block * 2, src += 64, dst += 64) {
+		__m256i v0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + 32));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_shuffle_epi8(v0, mask));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_shuffle_epi8(v1, mask));
+	}
+	for (; i + per_block <= n; i += per_block, src += 32, dst += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_shuffle_epi8(v, mask));
+	}
+	bulk_reverse_scalar<Size>(src, dst, n - i);
+}
+#endif /* TIP_UTIL_X86_SIMD */
+
+/**
+ * Reverse byte order of n values of Size bytes, choosing the widest
+ * kernel supported by the CPU. Buffers are taken as raw bytes, so
+ * the source can point directly into a network buffer.
+ */
+template < size_t Size >
+inline void
+bulk_reverse(char const* src, char* dst, size_t n)
+{
+	static_assert(Size == 2 || Size == 4 || Size == 8,
+			"Bulk conversion is supported for 16, 32 and 64-bit values");
+#ifdef TIP_UTIL_X86_SIMD
+	switch (simd::current_level()) {
+		case simd::level::avx2:
+			bulk_reverse_avx2<Size>(src, dst, n);
+			return;
+		case simd::level::ssse3:
+			bulk_reverse_ssse3<Size>(src, dst, n);
+			return;
+		default:
+			break;
+	}
+#endif
+	bulk_reverse_scalar<Size>(src, dst, n);
+}
+
+template < typename T >
+inline void
+bulk_copy(void const* src, void* dst, size_t n)
+{
+	if (src != dst)
+		std::memmove(dst, src, n * sizeof(T));
+}
+
+template < typename T >
+inline void
+bulk_reverse(void const* src, void* dst, size_t n)
+{
+	static_assert(std::is_arithmetic<T>::value, "Value must be of arithmetic type");
+	bulk_reverse< sizeof(T) >(static_cast<char const*>(src), static_cast<char*>(dst), n);
+}
+}  // namespace detail
+
+/**
+ * Convert n big-endian values from a raw buffer to native byte order.
+ * @param src buffer with big-endian values, needn't be aligned
+ * @param dst output, may be the same as src
+ * @param n number of values
+ */
+template < typename T >
+inline void
+big_to_native(void const* src, T* dst, size_t n)
+{
+#if BOOST_ENDIAN_BIG_BYTE
+	detail::bulk_copy<T>(src, dst, n);
+#else
+	detail::bulk_reverse<T>(src, dst, n);
+#endif
+}
+
+/**
+ * Convert n values in native byte order to big-endian raw buffer.
+ * @param src values in native byte order
+ * @param dst output buffer, needn't be aligned, may be the same as src
+ * @param n number of values
+ */
+template < typename T >
+inline void
+native_to_big(T const* src, void* dst, size_t n)
+{
+#if BOOST_ENDIAN_BIG_BYTE
+	detail::bulk_copy<T>(src, dst, n);
+#else
+	detail::bulk_reverse<T>(src, dst, n);
+#endif
+}
+//@}
+
 }  // namespace endian
 }  // namespace util
 }  // namespace tip
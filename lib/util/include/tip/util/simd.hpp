@@ -0,0 +1,72 @@
+/**
+ * simd.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef LIB_PG_ASYNC_INCLUDE_TIP_UTIL_SIMD_HPP_
+#define LIB_PG_ASYNC_INCLUDE_TIP_UTIL_SIMD_HPP_
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+	(defined(__x86_64__) || defined(__i386__)) && \
+	!defined(TIP_UTIL_NO_SIMD)
+/**
+ * Kernels for x86 instruction set extensions are compiled with
+ * function-level target attributes and selected at runtime.
+ */
+#define TIP_UTIL_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace tip {
+namespace util {
+namespace simd {
+
+/**
+ * Instruction set available for vectorized kernels
+ */
+enum class level {
+	scalar,
+	ssse3,
+	avx2
+};
+
+namespace detail {
+
+#ifdef TIP_UTIL_X86_SIMD
+inline level
+detect_level()
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return level::avx2;
+	if (__builtin_cpu_supports("ssse3"))
+		return level::ssse3;
+	return level::scalar;
+}
+#else
+inline level
+detect_level()
+{
+	return level::scalar;
+}
+#endif /* TIP_UTIL_X86_SIMD */
+
+}  // namespace detail
+
+/**
+ * Instruction set supported by the CPU, detected once
+ */
+inline level
+current_level()
+{
+	static level const lvl = detail::detect_level();
+	return lvl;
+}
+
+}  // namespace simd
+}  // namespace util
+}  // namespace tip
+
+#endif /* LIB_PG_ASYNC_INCLUDE_TIP_UTIL_SIMD_HPP_ */
@@ -21,8 +21,41 @@ const std::map< isolation_level, std::string > ISOLATION_TO_STRING {
     { isolation_level::repeatable_read, "repeatable read" },
     { isolation_level::serializable, "serializable" },
 }; // ISOLATION_TO_STRING
+
+const std::map< std::string, host_role > STRING_TO_ROLE {
+    { "primary", host_role::primary },
+    { "replica", host_role::replica },
+}; // STRING_TO_ROLE
+
+const std::map< std::string, target_session_attrs > STRING_TO_SESSION_ATTRS {
+    { "any",        target_session_attrs::any },
+    { "read-write", target_session_attrs::read_write },
+    { "primary",    target_session_attrs::read_write },
+    { "read-only",  target_session_attrs::read_only },
+    { "standby",    target_session_attrs::read_only },
+}; // STRING_TO_SESSION_ATTRS
 }  // namespace
 
+::std::ostream&
+operator << (::std::ostream& os, host_role val)
+{
+    std::ostream::sentry s(os);
+    if (s) {
+        switch (val) {
+            case host_role::primary:
+                os << "primary";
+                break;
+            case host_role::replica:
+                os << "replica";
+                break;
+            default:
+                os << "Unknown host role " << static_cast<int>(val);
+                break;
+        }
+    }
+    return os;
+}
+
 ::std::ostream&
 operator << (::std::ostream& os, isolation_level val)
 {
@@ -38,6 +71,29 @@ operator << (::std::ostream& os, isolation_level val)
     return os;
 }
 
+::std::ostream&
+operator << (::std::ostream& os, target_session_attrs val)
+{
+    std::ostream::sentry s(os);
+    if (s) {
+        switch (val) {
+            case target_session_attrs::any:
+                os << "any";
+                break;
+            case target_session_attrs::read_write:
+                os << "read-write";
+                break;
+            case target_session_attrs::read_only:
+                os << "read-only";
+                break;
+            default:
+                os << "Unknown target session attrs " << static_cast<int>(val);
+                break;
+        }
+    }
+    return os;
+}
+
 ::std::ostream&
 operator << (::std::ostream& os, transaction_mode const& val)
 {
@@ -76,6 +132,8 @@ struct connect_string_parser {
         url,
         database,
         done,
+        option_name,
+        option_value,
     } state;
 
 
@@ -87,9 +145,36 @@ struct connect_string_parser {
     connection_options
     operator ()(std::string const& literal) {
         std::string current;
+        std::string option;
         connection_options opts;
         for (auto p = literal.begin(); p != literal.end(); ++p) {
             switch (state) {
+                case done:
+                    if (*p == '?') {
+                        state = option_name;
+                    } else if (!std::isspace(*p)) {
+                        throw std::runtime_error("invalid connection string");
+                    }
+                    break;
+                case option_name:
+                    if (*p == '=') {
+                        option.swap(current);
+                        current.clear();
+                        state = option_value;
+                    } else if (!std::isspace(*p)) {
+                        current.push_back(*p);
+                    }
+                    break;
+                case option_value:
+                    if (*p == '&') {
+                        set_option(opts, option, current);
+                        option.clear();
+                        current.clear();
+                        state = option_name;
+                    } else if (!std::isspace(*p)) {
+                        current.push_back(*p);
+                    }
+                    break;
                 case schema_slash1:
                 case schema_slash2:
                     if (*p != '/')
@@ -169,10 +254,122 @@ struct connect_string_parser {
                 }
             }
         }
+        if (state == option_value) {
+            set_option(opts, option, current);
+        } else if (state == option_name && !current.empty()) {
+            throw std::runtime_error("invalid connection string option " + current);
+        }
         return opts;
     }
+
+    /**
+     * Options after the database name, `?name=value&name=value`
+     */
+    static void
+    set_option(connection_options& opts, std::string const& name,
+            std::string const& value)
+    {
+        if (name == "role") {
+            auto f = STRING_TO_ROLE.find(value);
+            if (f == STRING_TO_ROLE.end())
+                throw std::runtime_error("invalid host role " + value);
+            opts.role = f->second;
+        } else if (name == "target_session_attrs") {
+            auto f = STRING_TO_SESSION_ATTRS.find(value);
+            if (f == STRING_TO_SESSION_ATTRS.end())
+                throw std::runtime_error("invalid target session attrs " + value);
+            opts.session_attrs = f->second;
+        } else if (name == "load_balance_hosts") {
+            if (value == "random") {
+                opts.random_host_order = true;
+            } else if (value == "disable") {
+                opts.random_host_order = false;
+            } else {
+                throw std::runtime_error("invalid load balance hosts " + value);
+            }
+        } else if (name == "tcp_nodelay") {
+            opts.tcp.no_delay = to_flag(name, value);
+        } else if (name == "keepalives") {
+            opts.tcp.keepalives = to_flag(name, value);
+        } else if (name == "keepalives_idle") {
+            opts.tcp.keepalives_idle = tcp_options::seconds{ to_number(name, value) };
+        } else if (name == "keepalives_interval") {
+            opts.tcp.keepalives_interval = tcp_options::seconds{ to_number(name, value) };
+        } else if (name == "keepalives_count") {
+            opts.tcp.keepalives_count = to_number(name, value);
+        } else if (name == "tcp_user_timeout") {
+            opts.tcp.user_timeout = tcp_options::milliseconds{ to_number(name, value) };
+        } else if (name == "recv_buffer_size") {
+            opts.tcp.recv_buffer_size = to_number(name, value);
+        } else if (name == "send_buffer_size") {
+            opts.tcp.send_buffer_size = to_number(name, value);
+        } else if (name == "sslrootcert") {
+            opts.ssl_root_cert = value;
+        } else if (name == "dns_cache_ttl") {
+            opts.tcp.dns_cache_ttl = tcp_options::seconds{ to_number(name, value) };
+        } else if (name == "read_buffer_min") {
+            opts.read_buffer_min = to_number(name, value);
+        } else if (name == "read_buffer_max") {
+            opts.read_buffer_max = to_number(name, value);
+        } else if (name == "io") {
+            if (value == "uring") {
+                opts.io_uring = true;
+            } else if (value == "reactor") {
+                opts.io_uring = false;
+            } else {
+                throw std::runtime_error("invalid io " + value);
+            }
+        } else if (name == "threading") {
+            if (value == "single") {
+                opts.single_threaded = true;
+            } else if (value == "multi") {
+                opts.single_threaded = false;
+            } else {
+                throw std::runtime_error("invalid threading " + value);
+            }
+        } else {
+            throw std::runtime_error("invalid connection string option " + name);
+        }
+    }
+
+    /** Boolean option value, `1` or `0` */
+    static bool
+    to_flag(std::string const& name, std::string const& value)
+    {
+        if (value == "1")
+            return true;
+        if (value == "0")
+            return false;
+        throw std::runtime_error("invalid " + name + " value " + value);
+    }
+
+    /** Non-negative integer option value */
+    static int
+    to_number(std::string const& name, std::string const& value)
+    {
+        if (value.empty() || value.size() > 9 ||
+                value.find_first_not_of("0123456789") != std::string::npos)
+            throw std::runtime_error("invalid " + name + " value " + value);
+        return std::stoi(value);
+    }
 };
 
+std::vector< std::string >
+connection_options::hosts() const
+{
+    std::vector< std::string > res;
+    std::string::size_type start = 0;
+    while (start <= uri.size()) {
+        std::string::size_type end = uri.find(',', start);
+        if (end == std::string::npos)
+            end = uri.size();
+        if (end > start)
+            res.push_back(uri.substr(start, end - start));
+        start = end + 1;
+    }
+    return res;
+}
+
 void
 connection_options::generate_alias()
 {
@@ -10,6 +10,9 @@
 
 #include <tip/db/pg/log.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <random>
 #include <stdexcept>
 #include <mutex>
 
@@ -30,8 +33,132 @@ db_service_lock()
     return _mtx;
 }
 
+/**
+ * State of a transaction run by db_service::run_transaction, shared by the
+ * callbacks of all attempts
+ */
+struct transaction_runner : ::std::enable_shared_from_this< transaction_runner > {
+    using duration = retry_policy::duration;
+    using database_ptr = ::std::weak_ptr< detail::database_impl >;
+
+    dbalias                     alias;
+    transaction_mode            mode;
+    transaction_callback        body;
+    simple_callback             done;
+    error_callback              error;
+    retry_policy                policy;
+
+    database_ptr                db;
+    asio_config::steady_timer   timer;
+    ::std::minstd_rand          random;
+    ::std::size_t               attempt;
+    /** The last attempt that has an outcome */
+    ::std::atomic< ::std::size_t > settled;
+
+    transaction_runner(::std::shared_ptr< detail::database_impl > svc,
+            dbalias const& a,
+            transaction_mode const& m, transaction_callback const& b,
+            simple_callback const& d, error_callback const& e,
+            retry_policy const& p)
+        : alias{a}, mode{m}, body{b}, done{d}, error{e}, policy{p},
+          db{svc}, timer{*svc->io_service()}, random{ ::std::random_device{}() },
+          attempt{0}, settled{0}
+    {
+        mode.autocommit = false;
+    }
+
+    void
+    start()
+    {
+        auto svc = db.lock();
+        if (!svc)
+            throw error::connection_error("Database service is not running");
+        ::std::size_t n = ++attempt;
+        auto self = shared_from_this();
+        events::begin evt{
+            [self](transaction_ptr tran)
+            {
+                self->body(tran);
+            },
+            [self, n](error::db_error const& e)
+            {
+                self->handle_error(n, e);
+            },
+            mode
+        };
+        evt.finished = [self, n]()
+            {
+                if (self->settle(n) && self->done)
+                    self->done();
+            };
+        svc->get_connection(alias, ::std::move(evt));
+    }
+
+    /**
+     * Only the first outcome of an attempt counts, a failed transaction
+     * reports several errors.
+     */
+    bool
+    settle(::std::size_t n)
+    {
+        ::std::size_t prev = n - 1;
+        return settled.compare_exchange_strong(prev, n);
+    }
+
+    void
+    handle_error(::std::size_t n, error::db_error const& e)
+    {
+        if (!settle(n))
+            return;
+        if (n >= policy.max_attempts || !policy.retryable(e)) {
+            if (n > 1) {
+                local_log(logger::WARNING) << "Transaction failed after "
+                        << n << " attempts: " << e.what();
+            }
+            if (error)
+                error(e);
+            return;
+        }
+        duration bound = policy.delay_bound(n);
+        duration delay{ ::std::uniform_int_distribution< duration::rep >{
+                0, bound.count() }(random) };
+        local_log(logger::INFO) << "Transaction failed (" << e.code
+                << "), retry " << n << " in " << delay.count() << "ms";
+        auto self = shared_from_this();
+        timer.expires_from_now(delay);
+        timer.async_wait(
+        [self](asio_config::error_code const& ec)
+        {
+            if (ec)
+                return;
+            try {
+                self->start();
+            } catch (error::db_error const& err) {
+                if (self->error)
+                    self->error(err);
+            }
+        });
+    }
+};
+
 }  // namespace
 
+bool
+retry_policy::retryable(error::db_error const& e) const
+{
+    return ::std::find(sqlstates.begin(), sqlstates.end(), e.sqlstate)
+            != sqlstates.end();
+}
+
+retry_policy::duration
+retry_policy::delay_bound(::std::size_t retry) const
+{
+    duration bound = base_delay;
+    for (::std::size_t i = 1; i < retry && bound < max_delay; ++i)
+        bound *= 2;
+    return ::std::min(bound, max_delay);
+}
+
 db_service::pimpl&
 db_service::impl_ptr()
 {
@@ -46,21 +173,28 @@ db_service::impl(size_t pool_size, connection_params const& defaults)
 
     auto& pimpl = impl_ptr();
     if (!pimpl) {
-        pimpl.reset(new detail::database_impl(pool_size, defaults));
+        pimpl.reset(new detail::database_impl(pool_options{pool_size}, defaults));
     }
     return pimpl;
 }
 
 void
 db_service::initialize(size_t pool_size, connection_params const& defaults)
+{
+    initialize(pool_options{pool_size}, defaults);
+}
+
+void
+db_service::initialize(pool_options const& po, connection_params const& defaults,
+        size_t shards)
 {
     lock_type lock(db_service_lock());
 
     auto& pimpl = impl_ptr();
     if (!pimpl) {
-        pimpl.reset(new detail::database_impl(pool_size, defaults));
+        pimpl.reset(new detail::database_impl(po, defaults, shards));
     } else {
-        pimpl->set_defaults(pool_size, defaults);
+        pimpl->set_defaults(po, defaults, shards);
     }
 }
 
@@ -76,6 +210,19 @@ db_service::add_connection(connection_options const& co, optional_size pool_size
     impl()->add_connection(co, pool_size);
 }
 
+void
+db_service::add_connection(std::string const& connection_string,
+        pool_options const& po)
+{
+    impl()->add_connection(connection_options::parse(connection_string), po);
+}
+
+void
+db_service::add_connection(connection_options const& co, pool_options const& po)
+{
+    impl()->add_connection(co, po);
+}
+
 void
 db_service::begin(dbalias const& alias,
         transaction_callback const& result,
@@ -83,7 +230,29 @@ db_service::begin(dbalias const& alias,
         transaction_mode const& mode)
 {
     // TODO Wrap callbacks in strands
-    impl()->get_connection(alias, result, error, mode);
+    impl()->get_connection(alias, events::begin{result, error, mode});
+}
+
+void
+db_service::run_transaction(dbalias const& alias, transaction_mode const& mode,
+        transaction_callback const& body, simple_callback const& done,
+        error_callback const& error, retry_policy const& policy)
+{
+    auto runner = ::std::make_shared< transaction_runner >(
+            impl(), alias, mode, body, done, error, policy);
+    runner->start();
+}
+
+pool_metrics
+db_service::metrics(dbalias const& alias)
+{
+    return impl()->metrics(alias);
+}
+
+std::vector< pool_metrics >
+db_service::metrics()
+{
+    return impl()->metrics();
 }
 
 void
@@ -92,17 +261,36 @@ db_service::run()
     impl()->run();
 }
 
+void
+db_service::start(runner_options const& opts)
+{
+    impl()->start(opts);
+}
+
 void
 db_service::stop()
 {
-    lock_type lock(db_service_lock());
-    local_log(logger::INFO) << "Stop db service";
+    pimpl p;
+    {
+        lock_type lock(db_service_lock());
+        local_log(logger::INFO) << "Stop db service";
 
-    auto& pimpl = impl_ptr();
-    if (pimpl) {
-        pimpl->stop();
+        auto& pimpl = impl_ptr();
+        if (pimpl) {
+            pimpl->stop();
+        }
+        p.swap(pimpl);
     }
-    pimpl.reset();
+    // The runner threads can call the service, wait for them unlocked
+    if (p) {
+        p->wait();
+    }
+}
+
+std::vector< latency_histogram >
+db_service::event_loop_lag()
+{
+    return impl()->event_loop_lag();
 }
 
 asio_config::io_service_ptr
@@ -111,6 +299,30 @@ db_service::io_service()
     return impl()->io_service();
 }
 
+asio_config::io_service_ptr
+db_service::io_service(size_t shard)
+{
+    return impl()->io_service(shard);
+}
+
+size_t
+db_service::shard_count()
+{
+    return impl()->shard_count();
+}
+
+db_service::optional_size
+db_service::current_shard()
+{
+    return impl()->current_shard();
+}
+
+void
+db_service::post(size_t shard, simple_callback const& handler)
+{
+    impl()->io_service(shard)->post(handler);
+}
+
 }  // namespace pg
 }  // namespace db
 }  // namespace tip
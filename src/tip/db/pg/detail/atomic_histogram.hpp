@@ -0,0 +1,69 @@
+/*
+ * atomic_histogram.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_ATOMIC_HISTOGRAM_HPP_
+#define TIP_DB_PG_DETAIL_ATOMIC_HISTOGRAM_HPP_
+
+#include <tip/db/pg/metrics.hpp>
+
+#include <array>
+#include <atomic>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * Lock-free counterpart of latency_histogram
+ */
+struct atomic_histogram {
+    using duration      = latency_histogram::duration;
+    using counter_type  = ::std::atomic< latency_histogram::counter_type >;
+    using rep_type      = ::std::atomic< duration::rep >;
+
+    ::std::array< counter_type, latency_histogram::bucket_count > buckets;
+    counter_type    count;
+    rep_type        sum;
+    rep_type        max;
+
+    atomic_histogram() : count{0}, sum{0}, max{0}
+    {
+        for (auto& b : buckets)
+            b = 0;
+    }
+
+    void
+    record(duration val)
+    {
+        ++buckets[latency_histogram::bucket_of(val)];
+        ++count;
+        sum += val.count();
+        duration::rep curr = max.load();
+        while (curr < val.count() &&
+                !max.compare_exchange_weak(curr, val.count()));
+    }
+
+    latency_histogram
+    snapshot() const
+    {
+        latency_histogram h;
+        for (::std::size_t i = 0; i < buckets.size(); ++i)
+            h.buckets[i] = buckets[i];
+        h.count = count;
+        h.sum   = duration{ sum.load() };
+        h.max   = duration{ max.load() };
+        return h;
+    }
+};
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_ATOMIC_HISTOGRAM_HPP_ */
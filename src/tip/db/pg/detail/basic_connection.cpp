@@ -9,6 +9,10 @@
 
 #include <tip/db/pg/detail/connection_fsm.hpp>
 #include <tip/db/pg/detail/transport.hpp>
+#include <tip/db/pg/detail/uring_transport.hpp>
+#ifdef WITH_SSL
+#include <tip/db/pg/detail/ssl_transport.hpp>
+#endif
 
 #include <tip/db/pg/error.hpp>
 
@@ -23,29 +27,54 @@ namespace pg {
 
 LOCAL_LOGGING_FACILITY_CFG(PGCONN, config::CONNECTION_LOG);
 
-template < typename TransportType >
-std::shared_ptr< detail::concrete_connection< TransportType > >
-create_connection(asio_config::io_service_ptr svc,
+template < typename TransportType, typename Mutex >
+std::shared_ptr< detail::concrete_connection< TransportType, Mutex > >
+make_connection(asio_config::io_service_ptr svc,
         connection_options const& opts,
         client_options_type const& co,
-        connection_callbacks const& callbacks)
+        connection_callbacks const& callbacks,
+        detail::connection_caches const& caches)
 {
-    typedef detail::concrete_connection< TransportType > connection_type;
+    typedef detail::concrete_connection< TransportType, Mutex > connection_type;
     typedef std::shared_ptr< connection_type > concrete_connection_ptr;
 
-    concrete_connection_ptr conn(new connection_type(svc, co, callbacks));
+    concrete_connection_ptr conn(new connection_type(svc, co, callbacks, caches));
     conn->connect(opts);
     return conn;
 }
 
+template < typename TransportType >
+basic_connection_ptr
+create_connection(asio_config::io_service_ptr svc,
+        connection_options const& opts,
+        client_options_type const& co,
+        connection_callbacks const& callbacks,
+        detail::connection_caches const& caches)
+{
+    if (opts.single_threaded) {
+        return make_connection< TransportType, ::afsm::none >(
+                svc, opts, co, callbacks, caches);
+    }
+    return make_connection< TransportType, ::std::mutex >(
+            svc, opts, co, callbacks, caches);
+}
+
 basic_connection_ptr
 basic_connection::create(io_service_ptr svc, connection_options const& opts,
-        client_options_type const& co, connection_callbacks const& callbacks)
+        client_options_type const& co, connection_callbacks const& callbacks,
+        detail::connection_caches const& caches)
 {
     if (opts.schema == "tcp") {
-        return create_connection< detail::tcp_transport >(svc, opts, co, callbacks);
+        if (opts.io_uring) {
+            return create_connection< detail::uring_transport >(svc, opts, co, callbacks, caches);
+        }
+        return create_connection< detail::tcp_transport >(svc, opts, co, callbacks, caches);
     } else if (opts.schema == "socket") {
-        return create_connection< detail::socket_transport >(svc, opts, co, callbacks);
+        return create_connection< detail::socket_transport >(svc, opts, co, callbacks, caches);
+#ifdef WITH_SSL
+    } else if (opts.schema == "ssl") {
+        return create_connection< detail::ssl_transport >(svc, opts, co, callbacks, caches);
+#endif
     }
     std::stringstream os;
     os << "Schema " << opts.schema << " is unsupported";
@@ -73,6 +102,12 @@ basic_connection::alias() const
     return get_alias();
 }
 
+std::string const&
+basic_connection::host() const
+{
+    return get_host();
+}
+
 void
 basic_connection::begin(events::begin&& evt)
 {
@@ -97,6 +132,18 @@ basic_connection::in_transaction() const
     return is_in_transaction();
 }
 
+connection_metrics
+basic_connection::metrics() const
+{
+    return get_metrics();
+}
+
+basic_connection::io_service_ptr
+basic_connection::io_service() const
+{
+    return get_io_service();
+}
+
 void
 basic_connection::execute(events::execute&& query)
 {
@@ -116,6 +163,13 @@ basic_connection::terminate()
     do_terminate();
 }
 
+void
+basic_connection::cancel()
+{
+    local_log() << "Cancel query";
+    do_cancel();
+}
+
 }  // namespace pg
 }  // namespace db
 }  // namespace tip
@@ -11,14 +11,9 @@
 #include <boost/noncopyable.hpp>
 
 #include <tip/db/pg/asio_config.hpp>
+#include <tip/db/pg/metrics.hpp>
 #include <tip/db/pg/detail/protocol.hpp>
-
-namespace boost {
-namespace asio {
-// forward declaration
-class io_service;
-}  // namespace asio
-}  // namespace boost
+#include <tip/db/pg/detail/connection_caches.hpp>
 
 namespace tip {
 namespace db {
@@ -56,6 +51,8 @@ struct execute {
     std::string                 expression;
     query_internal_callback     result;
     query_error_callback        error;
+    /** Send COMMIT in the same write as the statement */
+    bool                        commit_after;
 };
 struct execute_prepared {
     std::string                 expression;
@@ -63,6 +60,8 @@ struct execute_prepared {
     std::vector< byte >         params;
     query_internal_callback     result;
     query_error_callback        error;
+    /** Send COMMIT in the same write as the statement */
+    bool                        commit_after;
 };
 
 }
@@ -71,9 +70,15 @@ class basic_connection : public boost::noncopyable {
 public:
     typedef asio_config::io_service_ptr io_service_ptr;
 public:
+    /**
+     * Create a connection with the transport for the schema of the options
+     * and start connecting.
+     * @param caches state shared with the other connections of a pool
+     */
     static basic_connection_ptr
     create(io_service_ptr svc, connection_options const&,
-            client_options_type const&, connection_callbacks const&);
+            client_options_type const&, connection_callbacks const&,
+            detail::connection_caches const& caches = detail::connection_caches{});
 public:
     virtual ~basic_connection();
 
@@ -82,6 +87,12 @@ public:
 
     dbalias const&
     alias() const;
+    /**
+     * The host the connection is established to, one of the hosts of
+     * a multi-host uri. Empty before the connection is established.
+     */
+    std::string const&
+    host() const;
 
     void
     begin(events::begin&&);
@@ -93,6 +104,12 @@ public:
     bool
     in_transaction() const;
 
+    connection_metrics
+    metrics() const;
+
+    io_service_ptr
+    io_service() const;
+
     void
     execute(events::execute&&);
     void
@@ -100,6 +117,13 @@ public:
 
     void
     terminate();
+    /**
+     * Ask the server to cancel the query being executed. Opens a side
+     * connection to send a CancelRequest, the connection itself is not
+     * affected. The query, if still running, fails with query_canceled.
+     */
+    void
+    cancel();
 protected:
     basic_connection();
 
@@ -110,9 +134,18 @@ private:
     virtual dbalias const&
     get_alias() const = 0;
 
+    virtual std::string const&
+    get_host() const = 0;
+
     virtual bool
     is_in_transaction() const = 0;
 
+    virtual connection_metrics
+    get_metrics() const = 0;
+
+    virtual io_service_ptr
+    get_io_service() const = 0;
+
     virtual void
     do_begin(events::begin&&) = 0;
     virtual void
@@ -127,6 +160,8 @@ private:
 
     virtual void
     do_terminate() = 0;
+    virtual void
+    do_cancel() = 0;
 };
 
 }  // namespace pg
@@ -0,0 +1,40 @@
+/*
+ * connection_caches.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_CONNECTION_CACHES_HPP_
+#define TIP_DB_PG_DETAIL_CONNECTION_CACHES_HPP_
+
+#include <memory>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+class resolver_cache;
+class scram_key_cache;
+class tls_session_cache;
+
+/**
+ * State shared by the connections of a pool, owned by the pool.
+ * A connection without a cache does the work itself.
+ */
+struct connection_caches {
+    /** Resolved host addresses */
+    ::std::shared_ptr< resolver_cache >     dns;
+    /** Keys derived from the password for SCRAM authentication */
+    ::std::shared_ptr< scram_key_cache >    scram;
+    /** TLS context and sessions of ssl connections */
+    ::std::shared_ptr< tls_session_cache >  tls;
+};
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_CONNECTION_CACHES_HPP_ */
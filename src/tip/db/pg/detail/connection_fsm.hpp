@@ -13,6 +13,7 @@
 #include <stack>
 #include <set>
 #include <memory>
+#include <sstream>
 
 #include <afsm/fsm.hpp>
 
@@ -23,10 +24,14 @@
 #include <tip/db/pg/resultset.hpp>
 
 #include <tip/db/pg/detail/basic_connection.hpp>
+#include <tip/db/pg/detail/connection_caches.hpp>
 #include <tip/db/pg/detail/protocol.hpp>
 #include <tip/db/pg/detail/md5.hpp>
+#include <tip/db/pg/detail/scram.hpp>
 #include <tip/db/pg/detail/result_impl.hpp>
 #include <tip/db/pg/detail/connection_observer.hpp>
+#include <tip/db/pg/detail/handler_allocator.hpp>
+#include <tip/db/pg/detail/read_buffer.hpp>
 
 #include <tip/db/pg/log.hpp>
 
@@ -44,6 +49,13 @@ struct authn_event {
     detail::message_ptr message;
 };
 struct complete {};
+/**
+ * Transaction started without waiting for the server. BEGIN goes out with
+ * the first command of the transaction, or is not sent in autocommit mode.
+ */
+struct started {};
+/** Ends an autocommit transaction that had no statement */
+struct autocommit {};
 
 struct ready_for_query {
     char status;
@@ -129,6 +141,19 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             fsm.notify_error(err);
         }
     };
+    struct reject_session {
+        template < typename SourceState, typename TargetState >
+        void
+        operator() (events::ready_for_query const&, connection_fsm_type& fsm,
+                SourceState&, TargetState&)
+        {
+            ::std::ostringstream os;
+            os << "Server " << fsm.host() << " session is not "
+                    << fsm.options().session_attrs;
+            fsm.log(logger::WARNING) << os.str();
+            fsm.notify_error(error::connection_error{os.str()});
+        }
+    };
     struct disconnect {
         template < typename SourceState, typename TargetState >
         void
@@ -141,6 +166,17 @@ struct connection_fsm_def : ::afsm::def::state_machine<
     };
     //@}
     //@{
+    /** @name Guards */
+    struct session_acceptable {
+        template < typename FSM, typename State >
+        bool
+        operator()(FSM const& fsm, State const&) const
+        {
+            return fsm.session_acceptable();
+        }
+    };
+    //@}
+    //@{
     /** @name States */
     struct unplugged : state< unplugged > {
         using deferred_events = ::psst::meta::type_tuple<
@@ -207,7 +243,18 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             template < typename SourceState, typename TargetState >
             void
             operator() (events::authn_event const& evt, connection_fsm_type& fsm,
-                    SourceState&, TargetState&)
+                    SourceState& state, TargetState&)
+            {
+                try {
+                    handle(evt, fsm, state);
+                } catch (error::connection_error const& e) {
+                    fsm.process_event(e);
+                }
+            }
+
+            void
+            handle(events::authn_event const& evt, connection_fsm_type& fsm,
+                    authn& state)
             {
                 fsm.log() << "authn: handle auth_event";
                 switch (evt.state) {
@@ -237,6 +284,55 @@ struct connection_fsm_def : ::afsm::def::state_machine<
                         fsm.send(::std::move(pm));
                         break;
                     }
+                    case SASL: {
+                        fsm.log() << "SASL authentication requested";
+                        bool supported = false;
+                        std::string mechanism;
+                        while (evt.message->read(mechanism) && !mechanism.empty()) {
+                            if (mechanism == scram_client::mechanism)
+                                supported = true;
+                            mechanism.clear();
+                        }
+                        if (!supported) {
+                            throw error::connection_error(
+                                    "No supported SASL mechanism offered by server");
+                        }
+                        state.scram_ = ::std::make_shared< scram_client >(
+                                fsm.options().password, fsm.caches().scram);
+                        std::string first = state.scram_->first_message();
+                        // SASLInitialResponse
+                        message pm(password_message_tag);
+                        pm.write(scram_client::mechanism);
+                        pm.write(integer(first.size()));
+                        ::std::copy(first.begin(), first.end(), pm.output());
+                        fsm.send(::std::move(pm));
+                        break;
+                    }
+                    case SASLContinue: {
+                        if (!state.scram_) {
+                            throw error::connection_error(
+                                    "Unexpected SASL challenge from server");
+                        }
+                        std::string final_message =
+                                state.scram_->final_message(sasl_data(evt));
+                        if (state.scram_->cached_keys())
+                            fsm.log() << "SCRAM keys taken from cache";
+                        // SASLResponse
+                        message pm(password_message_tag);
+                        ::std::copy(final_message.begin(), final_message.end(),
+                                pm.output());
+                        fsm.send(::std::move(pm));
+                        break;
+                    }
+                    case SASLFinal: {
+                        if (!state.scram_) {
+                            throw error::connection_error(
+                                    "Unexpected SASL outcome from server");
+                        }
+                        state.scram_->verify(sasl_data(evt));
+                        state.scram_.reset();
+                        break;
+                    }
                     default : {
                         std::stringstream err;
                         err << "Unsupported authentication scheme "
@@ -247,9 +343,23 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             }
         };
 
+        /** The rest of the message is the SASL data */
+        static std::string
+        sasl_data(events::authn_event const& evt)
+        {
+            std::string data;
+            char c;
+            while (evt.message->read(c))
+                data.push_back(c);
+            return data;
+        }
+
         using internal_transitions = transition_table<
             in< events::authn_event, handle_authn_event,    none >
         >;
+
+        /** SCRAM exchange in progress */
+        ::std::shared_ptr< scram_client > scram_;
     };
 
     struct idle : state< idle > {
@@ -297,7 +407,8 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             operator() (events::commit const&, transaction_fsm_type& fsm, SourceState&, TargetState&)
             {
                 fsm.log() << "transaction::commit_transaction";
-                fsm.connection().send_commit();
+                if (!fsm.end_autocommit())
+                    fsm.connection().send_commit();
             }
         };
         struct rollback_transaction {
@@ -306,17 +417,55 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             operator() (events::rollback const&, transaction_fsm_type& fsm, SourceState&, TargetState&)
             {
                 fsm.log() << "transaction::rollback_transaction";
-                fsm.connection().send_rollback();
+                if (!fsm.end_autocommit())
+                    fsm.connection().send_rollback();
                 fsm.notify_error(error::query_error("Transaction rolled back"));
             }
 
+            template < typename SourceState, typename TargetState >
+            void
+            operator() (error::query_error const& err, transaction_fsm_type& fsm,
+                    SourceState&, TargetState&)
+            {
+                fsm.log() << "transaction::rollback_transaction (on query error)";
+                fsm.failure_ = err;
+                if (!fsm.end_autocommit())
+                    fsm.connection().send_rollback();
+                fsm.notify_rolled_back();
+            }
+
             template < typename Event, typename SourceState, typename TargetState >
             void
             operator() (Event const&, transaction_fsm_type& fsm, SourceState&, TargetState&)
             {
                 fsm.log() << "transaction::rollback_transaction (on error)";
-                fsm.connection().send_rollback();
-                fsm.notify_error(error::query_error("Transaction rolled back"));
+                if (!fsm.end_autocommit())
+                    fsm.connection().send_rollback();
+                fsm.notify_rolled_back();
+            }
+        };
+        struct commit_failed {
+            template < typename SourceState, typename TargetState >
+            void
+            operator() (error::query_error const& err, transaction_fsm_type& fsm,
+                    SourceState& state, TargetState&)
+            {
+                fsm.log(logger::ERROR) << "transaction::commit_failed";
+                state.callback_ = notification_callback{};
+                state.committing_ = false;
+                fsm.notify_error(err);
+                if (state.error_) {
+                    auto error_cb = state.error_;
+                    state.error_ = error_callback{};
+                    fsm.connection().async_notify(
+                    [error_cb, err](){
+                        try {
+                            error_cb(err);
+                        } catch (...) {
+                            fsm_log(logger::WARNING) << "Exception in commit error handler";
+                        }
+                    });
+                }
             }
         };
 
@@ -360,6 +509,21 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         };
         //@}
         //@{
+        /** @name Guards */
+        /**
+         * The transaction ends with the statement's ReadyForQuery, the
+         * event is left to the enclosing state machine.
+         */
+        struct is_autocommit {
+            template < typename FSM, typename State >
+            bool
+            operator()(FSM const& fsm, State const&) const
+            {
+                return fsm.callbacks_.mode.autocommit;
+            }
+        };
+        //@}
+        //@{
         /** @name Transaction sub-states */
         struct starting : state< starting > {
             using deferred_events = ::psst::meta::type_tuple<
@@ -372,7 +536,10 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             void
             on_enter(events::begin const& evt, transaction_fsm_type& fsm)
             {
-                fsm.connection().send_begin(evt);
+                if (!evt.mode.autocommit) {
+                    fsm.connection().defer_begin(evt);
+                }
+                fsm.connection().process_event(events::started{});
             }
             using internal_transitions = transition_table<
             /*      Event                     Action      Guard     */
@@ -426,6 +593,16 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         };
 
         struct tran_error : state< tran_error > {
+            template < typename Event >
+            void
+            on_enter(Event const&, transaction_fsm_type&)
+            {
+            }
+            void
+            on_enter(error::query_error const& err, transaction_fsm_type& fsm)
+            {
+                fsm.failure_ = err;
+            }
             using internal_transitions = transition_table<
             /*                Event              Action                    Guard     */
             /*            +---------------------+-----------------------+---------+*/
@@ -439,21 +616,39 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             on_enter(Event const&, transaction_fsm_type& fsm)
             {
                 callback_ = notification_callback{};
+                error_ = error_callback{};
+                committing_ = false;
             }
             void
             on_enter(events::commit const& evt, transaction_fsm_type& fsm)
             {
                 callback_ = evt.callback;
+                error_ = evt.error;
+                committing_ = true;
             }
             void
             on_enter(events::rollback const& evt, transaction_fsm_type& fsm)
             {
                 callback_ = evt.callback;
+                error_ = evt.error;
+                committing_ = false;
             }
             template < typename Event >
             void
             on_exit(Event const&, transaction_fsm_type& fsm)
             {
+                if (committing_ && fsm.callbacks_.finished) {
+                    auto finished = fsm.callbacks_.finished;
+                    fsm.connection().async_notify(
+                        [finished](){
+                            try {
+                                finished();
+                            } catch (...) {
+                                fsm_log(logger::WARNING) << "Exception in transaction finished handler";
+                            }
+                        }
+                    );
+                }
                 if (callback_) {
                     auto cb = callback_;
                     fsm.connection().async_notify(
@@ -475,13 +670,16 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             /*                Event               Action          Guard    */
             /*    +-----------------------------+---------------+---------+*/
                 in< command_complete            , none          , none    >,
+                in< error::query_error          , commit_failed , none    >,
                 in< events::commit              , none          , none    >,
                 in< events::rollback            , none          , none    >,
                 in< events::execute             , tran_finished , none    >,
                 in< events::execute_prepared    , tran_finished , none    >
             >;
 
-            notification_callback callback_;
+            notification_callback   callback_;
+            error_callback          error_;
+            bool                    committing_ = false;
         };
         //--------------------------------------------------------------------
 
@@ -528,7 +726,9 @@ struct connection_fsm_def : ::afsm::def::state_machine<
                 log() << "Execute query: " << q.expression;
                 query_ = q;
                 message m(query_tag);
-                m.write(q.expression);
+                connection().write_query(m, q.expression);
+                if (q.commit_after)
+                    connection().pipeline_commit(m);
                 connection().send(::std::move(m));
             }
             template < typename Event, typename FSM >
@@ -767,6 +967,8 @@ struct connection_fsm_def : ::afsm::def::state_machine<
                 execute.write(row_limit_);
                 cmd.pack(execute);
                 cmd.pack(message(sync_tag));
+                if (query_.commit_after)
+                    connection().pipeline_commit(cmd);
 
                 connection().send(::std::move(cmd));
             }
@@ -945,7 +1147,7 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         using transitions = transition_table<
             /*        Start       Event                       Next                Action                  */
              /*+----------------+---------------------------+-------------------+-----------------------+ */
-             tr< starting       , events::ready_for_query   , idle              , transaction_started   >,
+             tr< starting       , events::started           , idle              , transaction_started   >,
              /*+----------------+---------------------------+-------------------+-----------------------+ */
              tr< idle           , events::commit            , exiting           , commit_transaction    >,
              tr< idle           , events::rollback          , exiting           , rollback_transaction  >,
@@ -953,27 +1155,46 @@ struct connection_fsm_def : ::afsm::def::state_machine<
              tr< idle           , error::client_error       , exiting           , rollback_transaction  >,
              /*+----------------+---------------------------+-------------------+-----------------------+ */
              tr< idle           , events::execute           , simple_query      , none                  >,
-             tr< simple_query   , events::ready_for_query   , idle              , none                  >,
+             tr< simple_query   , events::ready_for_query   , idle              , none                  , not_<is_autocommit>  >,
              tr< simple_query   , error::query_error        , tran_error        , none                  >,
              tr< simple_query   , error::client_error       , tran_error        , none                  >,
              tr< simple_query   , error::db_error           , tran_error        , none                  >,
              /*+----------------+---------------------------+-------------------+-----------------------+ */
              tr< idle           , events::execute_prepared  , extended_query    , none                  >,
-             tr< extended_query , events::ready_for_query   , idle              , none                  >,
+             tr< extended_query , events::ready_for_query   , idle              , none                  , not_<is_autocommit>  >,
              tr< extended_query , error::query_error        , tran_error        , none                  >,
              tr< extended_query , error::client_error       , tran_error        , none                  >,
              tr< extended_query , error::db_error           , tran_error        , none                  >,
              /*+----------------+---------------------------+-------------------+-----------------------+ */
-             tr< tran_error     , events::ready_for_query   , exiting           , rollback_transaction  >
+             tr< tran_error     , events::ready_for_query   , exiting           , rollback_transaction  , not_<is_autocommit>  >
         >;
 
         //@}
 
+        /**
+         * BEGIN is not sent in autocommit mode, so a transaction that ends
+         * before its statement has nothing to commit or roll back on the
+         * server. It leaves to the connection's idle state without a round
+         * trip.
+         * @return true if the transaction runs in autocommit mode
+         */
+        bool
+        end_autocommit()
+        {
+            if (!callbacks_.mode.autocommit)
+                return false;
+            log() << "No statement in autocommit mode, nothing to end";
+            connection().process_event(events::autocommit{});
+            return true;
+        }
+
         void
         notify_started()
         {
             if (callbacks_.started) {
-                transaction_ptr t(new pg::transaction( connection().shared_from_this() ));
+                transaction_ptr t(new pg::transaction( connection().shared_from_this(),
+                        callbacks_.mode.autocommit ));
+                t->start_deadline(callbacks_.mode.timeout);
                 tran_object_ = t;
                 try {
                     callbacks_.started(t);
@@ -1036,6 +1257,16 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             }
         }
 
+        /**
+         * Notify that the transaction was rolled back because of an error,
+         * the error carries the SQLSTATE of the failure
+         */
+        void
+        notify_rolled_back()
+        {
+            notify_error(error::query_error{ "Transaction rolled back",
+                failure_.severity, failure_.code, failure_.detail });
+        }
         void
         notify_error(error::db_error const& qe)
         {
@@ -1103,12 +1334,14 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         {
             connection().in_transaction_ = true;
             callbacks_ = evt;
+            failure_ = error::query_error{ "Transaction rolled back" };
         }
         template < typename Event, typename FSM >
         void
         on_exit(Event const&, FSM&)
         {
             connection().in_transaction_ = false;
+            connection().drop_pipelined_commit();
             auto tran = tran_object_.lock();
             if (tran) {
                 tran->mark_done();
@@ -1125,6 +1358,8 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         }
         events::begin           callbacks_;
         transaction_weak_ptr    tran_object_;
+        /** The error the transaction failed with */
+        error::query_error      failure_{ "Transaction rolled back" };
     }; // transaction state machine
     //------------------------------------------------------------------------
 
@@ -1141,7 +1376,8 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         tr< t_conn      , events::complete          , authn         , none                  >,
         tr< t_conn      , error::connection_error   , terminated    , on_connection_error   >,
 
-        tr< authn       , events::ready_for_query   , idle          , none                  >,
+        tr< authn       , events::ready_for_query   , idle          , none                  , session_acceptable        >,
+        tr< authn       , events::ready_for_query   , terminated    , reject_session        , not_<session_acceptable>  >,
         tr< authn       , error::connection_error   , terminated    , on_connection_error   >,
         /*  Transitions from idle                                                            */
         /*+-------------+---------------------------+---------------+-----------------------+*/
@@ -1150,6 +1386,7 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         tr< idle        , error::connection_error   , terminated    , on_connection_error   >,
         /*+-------------+---------------------------+---------------+-----------------------+*/
         tr< transaction , events::ready_for_query   , idle          , none                  >,
+        tr< transaction , events::autocommit        , idle          , none                  >,
         tr< transaction , error::connection_error   , terminated    , on_connection_error   >
     >;
     //@}
@@ -1171,13 +1408,16 @@ struct connection_fsm_def : ::afsm::def::state_machine<
     //@}
 
     //@{
-    connection_fsm_def(io_service_ptr svc, client_options_type const& co)
+    connection_fsm_def(io_service_ptr svc, client_options_type const& co,
+            connection_caches const& caches = connection_caches{})
         : shared_base(), io_service_{svc}, strand_{*svc}, transport_{svc},
-          client_opts_{co},
+          client_opts_{co}, caches_{caches},
           serverPid_{0}, serverSecret_{0}, in_transaction_{false},
-          connection_number_{ next_connection_number() }
+          begin_responses_{0}, commit_pipelined_{false}, commit_responses_{0},
+          connection_number_{ next_connection_number() },
+          queries_executed_{0}, error_responses_{0},
+          bytes_in_{0}, bytes_out_{0}
     {
-        incoming_.prepare(8192); // FIXME Magic number, move to configuration
     }
     virtual ~connection_fsm_def() {}
     //@}
@@ -1188,6 +1428,22 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         return connection_number_;
     }
 
+    connection_metrics
+    collect_metrics() const
+    {
+        connection_metrics m;
+        m.number    = connection_number_;
+        m.busy      = in_transaction_;
+        m.queries   = queries_executed_;
+        m.errors    = error_responses_;
+        m.bytes_in  = bytes_in_;
+        m.bytes_out = bytes_out_;
+        m.reads     = incoming_.reads();
+        m.full_reads = incoming_.full_reads();
+        m.read_size = incoming_.size();
+        return m;
+    }
+
     void
     connect_transport(connection_options const& opts)
     {
@@ -1201,12 +1457,13 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             throw error::connection_error("User not specified!");
         }
         conn_opts_ = opts;
+        incoming_.set_bounds(opts.read_buffer_min, opts.read_buffer_max);
         auto _this = shared_base::shared_from_this();
         transport_.connect_async(conn_opts_,
             [_this](asio_config::error_code const& ec)
             {
                 _this->handle_connect(ec);
-            });
+            }, caches_);
     }
     void
     close_transport()
@@ -1214,15 +1471,64 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         transport_.close();
     }
 
+    /**
+     * Send a CancelRequest over a side connection with the key data
+     * received at startup
+     */
+    void
+    send_cancel_request()
+    {
+        if (!serverPid_) {
+            log(logger::WARNING) << "No backend key data to cancel the query";
+            return;
+        }
+        log() << "Send cancel request";
+        message m(empty_tag);
+        m.write(CANCEL_REQUEST_CODE);
+        m.write(serverPid_);
+        m.write(serverSecret_);
+
+        auto msg = ::std::make_shared<message>(::std::move(m));
+        auto side = ::std::make_shared<transport_type>(io_service_);
+        auto _this = shared_base::shared_from_this();
+        side->connect_async(conn_opts_,
+        [_this, side, msg](asio_config::error_code const& ec)
+        {
+            if (ec) {
+                _this->log(logger::WARNING) << "Failed to connect to send "
+                        "cancel request: " << ec.message();
+                return;
+            }
+            auto data_range = msg->buffer();
+            side->async_write(
+                ASIO_NAMESPACE::buffer(&*data_range.first,
+                        data_range.second - data_range.first),
+                [side, msg](asio_config::error_code const&, size_t)
+                {
+                    // The server closes the connection without a reply
+                    side->close();
+                });
+        }, caches_);
+    }
+
+    io_service_ptr
+    io_service() const
+    { return io_service_; }
+
     void
     start_read()
     {
+        // Release the memory of a large result between transactions
+        if (!in_transaction_)
+            incoming_.shrink();
         auto _this = shared_base::shared_from_this();
-        transport_.async_read(incoming_,
+        auto buffer = incoming_.prepare();
+        transport_.async_read(buffer,
+            make_custom_alloc_handler(read_memory_,
             [_this](asio_config::error_code const& ec, size_t bytes_transferred)
             {
                 _this->handle_read(ec, bytes_transferred);
-            });
+            }));
     }
 
     void
@@ -1232,35 +1538,120 @@ struct connection_fsm_def : ::afsm::def::state_machine<
         create_startup_message(m);
         send(::std::move(m));
     }
+    /**
+     * BEGIN is sent together with the first command of the transaction,
+     * its responses are skipped when read. A simple query gets BEGIN
+     * prepended to its text, an extended query is preceded by BEGIN in the
+     * extended protocol without a Sync. Either way the server skips the
+     * statement if BEGIN fails.
+     */
     void
-    send_begin(events::begin const& evt)
+    defer_begin(events::begin const& evt)
     {
-        log() << "Send begin";
-        message m(query_tag);
-        ::std::ostringstream cmd{"begin"};
-        cmd << evt.mode;
-        m.write(cmd.str());
-        send(::std::move(m));
+        log() << "Defer begin";
+        ::std::ostringstream cmd;
+        cmd << "begin" << evt.mode;
+        deferred_begin_ = cmd.str();
+    }
+    /**
+     * Append COMMIT to a message, so that it goes out in the same write.
+     * The transaction end command that follows is not sent then, the
+     * server commits the transaction or rolls it back if it failed.
+     */
+    void
+    pipeline_commit(message& m)
+    {
+        log() << "Pipeline commit";
+        message cmd(query_tag);
+        cmd.write("commit");
+        m.pack(cmd);
+        commit_pipelined_ = true;
+    }
+    /**
+     * The transaction ended before ending it with the pipelined COMMIT,
+     * nothing waits for the COMMIT's responses. They follow the responses
+     * of the statement and are skipped when read.
+     */
+    void
+    drop_pipelined_commit()
+    {
+        if (commit_pipelined_.exchange(false)) {
+            log() << "Skip the responses of the pipelined commit";
+            // CommandComplete or ErrorResponse, and ReadyForQuery
+            commit_responses_ = 2;
+        }
+    }
+    /**
+     * Write the text of a simple query to the message, after the deferred
+     * BEGIN if there is one.
+     */
+    void
+    write_query(message& m, ::std::string const& expression)
+    {
+        if (deferred_begin_.empty()) {
+            m.write(expression);
+            return;
+        }
+        log() << "Send " << deferred_begin_ << " with the first command";
+        m.write(deferred_begin_ + "; " + expression);
+        deferred_begin_.clear();
+        // CommandComplete of the BEGIN
+        begin_responses_ = 1;
     }
     void
     send_commit()
     {
+        if (commit_pipelined_.exchange(false)) {
+            log() << "Commit already sent";
+            return;
+        }
         log() << "Send commit";
         message m(query_tag);
-        m.write("commit");
+        write_query(m, "commit");
         send(::std::move(m));
     }
     void
     send_rollback()
     {
+        if (commit_pipelined_.exchange(false)) {
+            log() << "Commit already sent, the server rolls back a failed transaction";
+            return;
+        }
         log() << "Send rollback";
         message m(query_tag);
-        m.write("rollback");
+        write_query(m, "rollback");
         send(::std::move(m));
     }
     void
     send(message&& m, asio_io_handler handler = asio_io_handler())
     {
+        if (!deferred_begin_.empty() &&
+                (m.tag() == parse_tag || m.tag() == bind_tag)) {
+            log() << "Send " << deferred_begin_ << " with the first command";
+            // Unnamed statement and portal, no Sync. If BEGIN fails, the
+            // server discards the messages up to the statement's Sync.
+            message cmd(parse_tag);
+            cmd.write(::std::string{});
+            cmd.write(deferred_begin_);
+            cmd.write((smallint)0); // parameter types
+            message bind(bind_tag);
+            bind.write(::std::string{});
+            bind.write(::std::string{});
+            bind.write((smallint)0); // parameter format codes
+            bind.write((smallint)0); // number of parameters
+            bind.write((smallint)0); // result format codes
+            message execute(execute_tag);
+            execute.write(::std::string{});
+            execute.write((integer)0);
+            cmd.pack(bind);
+            cmd.pack(execute);
+            cmd.pack(m);
+            deferred_begin_.clear();
+            // ParseComplete, BindComplete and CommandComplete of the BEGIN
+            begin_responses_ = 3;
+            send(::std::move(cmd), handler);
+            return;
+        }
         if (transport_.connected()) {
             auto msg = ::std::make_shared<message>(::std::move(m));
             auto data_range = msg->buffer();
@@ -1268,6 +1659,7 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             auto write_handler =
                 [_this, handler, msg](asio_config::error_code const& ec, size_t sz)
                 {
+                    _this->bytes_out_ += sz;
                     if (handler)
                         handler(ec, sz);
                     else
@@ -1276,7 +1668,7 @@ struct connection_fsm_def : ::afsm::def::state_machine<
             transport_.async_write(
                 ASIO_NAMESPACE::buffer(&*data_range.first,
                         data_range.second - data_range.first),
-                write_handler
+                make_custom_alloc_handler(write_memory_, write_handler)
             );
         }
     }
@@ -1285,6 +1677,36 @@ struct connection_fsm_def : ::afsm::def::state_machine<
     options() const
     { return conn_opts_; }
 
+    connection_caches const&
+    caches() const
+    { return caches_; }
+
+    /** Host connected to */
+    std::string const&
+    host() const
+    { return transport_.host(); }
+
+    /**
+     * Check the server session against the target session attrs, using the
+     * parameters reported by the server.
+     */
+    bool
+    session_acceptable() const
+    {
+        if (conn_opts_.session_attrs == target_session_attrs::any)
+            return true;
+        auto hot_standby = client_opts_.find("in_hot_standby");
+        auto read_only = client_opts_.find("default_transaction_read_only");
+        if (hot_standby == client_opts_.end() && read_only == client_opts_.end()) {
+            log(logger::WARNING) << "Server " << host()
+                    << " doesn't report session read-only state";
+            return true;
+        }
+        bool ro = (hot_standby != client_opts_.end() && hot_standby->second == "on") ||
+                (read_only != client_opts_.end() && read_only->second == "on");
+        return ro == (conn_opts_.session_attrs == target_session_attrs::read_only);
+    }
+
     //@{
     /** @name Prepared queries */
     bool
@@ -1345,11 +1767,22 @@ struct connection_fsm_def : ::afsm::def::state_machine<
     void
     notify_error(error::connection_error const& e) { do_notify_error(e); }
 
+    /**
+     * Post the handler to the connection strand. The handler memory is
+     * recycled, the connection is kept alive until the handler runs.
+     */
     template < typename Handler >
     void
     async_notify(Handler&& h)
     {
-        strand_.post( ::std::forward<Handler>(h) );
+        using handler_type = typename ::std::decay<Handler>::type;
+        auto _this = shared_base::shared_from_this();
+        handler_type handler(::std::forward<Handler>(h));
+        strand_.post( make_custom_alloc_handler(notify_memory_,
+            [_this, handler]() mutable
+            {
+                handler();
+            }) );
     }
     //@}
 
@@ -1378,6 +1811,7 @@ private:
     handle_connect(asio_config::error_code const& ec)
     {
         if (!ec) {
+            conn_opts_.uri = transport_.host();
             fsm().process_event(events::complete{});
         } else {
             fsm().process_event( error::connection_error{ec.message()} );
@@ -1387,9 +1821,10 @@ private:
     handle_read(asio_config::error_code const& ec, size_t bytes_transferred)
     {
         if (!ec) {
+            bytes_in_ += bytes_transferred;
             // read message
-            std::istreambuf_iterator<char> in(&incoming_);
-            read_message(in, bytes_transferred);
+            read_message(incoming_.data(), bytes_transferred);
+            incoming_.record(bytes_transferred);
             // start async operation again
             start_read();
         } else {
@@ -1417,16 +1852,16 @@ private:
     }
 
     void
-    read_message( std::istreambuf_iterator< char > in, size_t max_bytes )
+    read_message( char const* in, size_t max_bytes )
     {
         const size_t header_size = sizeof(integer) + sizeof(byte);
+        char const* eos = in + max_bytes;
         while (max_bytes > 0) {
             if (!message_) {
                 message_.reset(new detail::message);
             }
             auto out = message_->output();
 
-            std::istreambuf_iterator<char> eos;
             if (message_->buffer_size() < header_size) {
                 // Read the header
                 size_t to_read = std::min((header_size - message_->buffer_size()), max_bytes);
@@ -1485,6 +1920,18 @@ private:
                 case command_complete_tag: {
                     command_complete cmpl;
                     m->read(cmpl.command_tag);
+                    if (begin_responses_ > 0) {
+                        log() << "Pipelined begin complete ("
+                                << cmpl.command_tag << ")";
+                        --begin_responses_;
+                        break;
+                    }
+                    if (commit_responses_ == 2) {
+                        log() << "Pipelined commit complete ("
+                                << cmpl.command_tag << ")";
+                        --commit_responses_;
+                        break;
+                    }
                     log() << "Command complete ("
                             << cmpl.command_tag << ")";
                     fsm().process_event(cmpl);
@@ -1496,8 +1943,19 @@ private:
                     break;
                 }
                 case error_response_tag: {
+                    ++error_responses_;
                     notice_message msg;
                     m->read(msg);
+                    if (begin_responses_ > 0) {
+                        // The BEGIN failed, the server skipped the statement
+                        // sent with it, the error is the statement's one
+                        begin_responses_ = 0;
+                    }
+                    if (commit_responses_ == 2) {
+                        log(logger::ERROR) << "Pipelined commit failed " << msg;
+                        --commit_responses_;
+                        break;
+                    }
 
                     log(logger::ERROR) << "Error " << msg ;
                     error::query_error err(msg.message, msg.severity,
@@ -1525,6 +1983,12 @@ private:
                 case ready_for_query_tag: {
                     char stat(0);
                     m->read(stat);
+                    if (commit_responses_ > 0) {
+                        log() << "Pipelined commit ready for query ("
+                                << stat << ")";
+                        commit_responses_ = 0;
+                        break;
+                    }
                     log() << "Database "
                         << (util::CLEAR) << (util::RED | util::BRIGHT)
                         << conn_opts_.uri
@@ -1563,6 +2027,11 @@ private:
                     break;
                 }
                 case parse_complete_tag: {
+                    if (begin_responses_ > 0) {
+                        log() << "Pipelined begin parse complete";
+                        --begin_responses_;
+                        break;
+                    }
                     log() << "Parse complete";
                     fsm().process_event(events::parse_complete{});
                     break;
@@ -1572,6 +2041,11 @@ private:
                     break;
                 }
                 case bind_complete_tag: {
+                    if (begin_responses_ > 0) {
+                        log() << "Pipelined begin bind complete";
+                        --begin_responses_;
+                        break;
+                    }
                     log() << "Bind complete";
                     fsm().process_event(events::bind_complete{});
                     break;
@@ -1609,11 +2083,18 @@ private:
     friend class transaction;
     asio_config::io_service_ptr     io_service_;
     asio_config::io_service::strand strand_;
+    //@{
+    /** @name Recycled memory of read, write and notification handlers */
+    handler_memory<>                read_memory_;
+    handler_memory<>                write_memory_;
+    handler_memory<>                notify_memory_;
+    //@}
     transport_type                  transport_;
 
     client_options_type             client_opts_;
+    connection_caches               caches_;
 
-    ASIO_NAMESPACE::streambuf       incoming_;
+    read_buffer                     incoming_;
 
     message_ptr                     message_;
 
@@ -1623,31 +2104,55 @@ private:
     prepared_statements_map         prepared_;
 
     ::std::atomic<bool>             in_transaction_;
+    /** BEGIN command waiting for the first command of the transaction */
+    ::std::string                   deferred_begin_;
+    /** Responses of a pipelined BEGIN to skip */
+    ::std::atomic<int>              begin_responses_;
+    /** COMMIT was sent after the last statement */
+    ::std::atomic<bool>             commit_pipelined_;
+    /** Responses of a pipelined COMMIT to skip */
+    ::std::atomic<int>              commit_responses_;
 
     size_t                          connection_number_;
 protected:
+    using atomic_counter = ::std::atomic< ::std::uint64_t >;
+
     connection_options              conn_opts_;
+
+    atomic_counter                  queries_executed_;
+    atomic_counter                  error_responses_;
+    atomic_counter                  bytes_in_;
+    atomic_counter                  bytes_out_;
 };
 
 //----------------------------------------------------------------------------
 // Concrete connection
 //----------------------------------------------------------------------------
-template < typename TransportType >
+/**
+ * Connection over a transport.
+ *
+ * The Mutex guards the event processing of the state machine. With
+ * ::afsm::none the events are not locked, all of them must be processed
+ * by a single thread.
+ */
+template < typename TransportType, typename Mutex = ::std::mutex >
 class concrete_connection : public basic_connection,
-    public ::afsm::state_machine< connection_fsm_def< ::std::mutex, TransportType,
-        concrete_connection< TransportType > >, ::std::mutex, connection_observer > {
+    public ::afsm::state_machine< connection_fsm_def< Mutex, TransportType,
+        concrete_connection< TransportType, Mutex > >, Mutex, connection_observer > {
 public:
     using transport_type = TransportType;
-    using this_type = concrete_connection< transport_type >;
+    using mutex_type = Mutex;
+    using this_type = concrete_connection< transport_type, mutex_type >;
     using fsm_type =
             ::afsm::state_machine<
-                 connection_fsm_def< ::std::mutex, transport_type, this_type >,
-                 ::std::mutex, connection_observer >;
+                 connection_fsm_def< mutex_type, transport_type, this_type >,
+                 mutex_type, connection_observer >;
 public:
     concrete_connection(io_service_ptr svc,
             client_options_type const& co,
-            connection_callbacks const& callbacks)
-        : basic_connection(), fsm_type(svc, co),
+            connection_callbacks const& callbacks,
+            connection_caches const& caches = connection_caches{})
+        : basic_connection(), fsm_type(svc, co, caches),
           callbacks_(callbacks)
     {
         if (PGFSM_DEFAULT_SEVERITY > logger::OFF)
@@ -1682,7 +2187,7 @@ private:
     {
         log(logger::ERROR) << "Connection error " << e.what();
         if (callbacks_.error) {
-            callbacks_.error(connection_ptr(), e);
+            callbacks_.error(fsm_type::shared_from_this(), e);
         } else {
             log(logger::ERROR) << "No connection_error callback";
         }
@@ -1701,11 +2206,29 @@ private:
         return fsm_type::conn_opts_.alias;
     }
 
+    virtual std::string const&
+    get_host() const override
+    {
+        return fsm_type::host();
+    }
+
     virtual bool
     is_in_transaction() const override
     {
         return fsm_type::in_transaction();
     }
+
+    virtual connection_metrics
+    get_metrics() const override
+    {
+        return fsm_type::collect_metrics();
+    }
+
+    virtual io_service_ptr
+    get_io_service() const override
+    {
+        return fsm_type::io_service();
+    }
     virtual void
     do_begin(events::begin&& evt) override
     {
@@ -1713,7 +2236,7 @@ private:
             log(logger::ERROR) << "Cannot begin transaction: already in transaction";
             throw error::db_error("Already in transaction");
         }
-        fsm_type::process_event(::std::move(evt));
+        process_external(::std::move(evt));
     }
 
     virtual void
@@ -1725,7 +2248,7 @@ private:
                 ecb(error::db_error("Not in transaction"));
             }
         }
-        fsm_type::process_event(events::commit{cb, ecb});
+        process_external(events::commit{cb, ecb});
     }
 
     virtual void
@@ -1737,25 +2260,66 @@ private:
                 ecb(error::db_error("Not in transaction"));
             }
         }
-        fsm_type::process_event(events::rollback{cb, ecb});
+        process_external(events::rollback{cb, ecb});
     }
 
     virtual void
     do_execute(events::execute&& query) override
     {
-        fsm_type::process_event(::std::move(query));
+        ++fsm_type::queries_executed_;
+        process_external(::std::move(query));
     }
 
     virtual void
     do_execute(events::execute_prepared&& query) override
     {
-        fsm_type::process_event(::std::move(query));
+        ++fsm_type::queries_executed_;
+        process_external(::std::move(query));
     }
 
     virtual void
     do_terminate() override
     {
-        fsm_type::process_event(events::terminate{});
+        process_external(events::terminate{});
+    }
+
+    virtual void
+    do_cancel() override
+    {
+        fsm_type::send_cancel_request();
+    }
+
+    /**
+     * Feed an event that comes through the connection interface. Without
+     * a mutex the state machine must be used only by the thread running
+     * the io_service, while e.g. terminate comes from the pool on stopping
+     * the service, so the event is dispatched to the io_service.
+     */
+    template < typename Event >
+    void
+    process_external(Event&& evt)
+    {
+        process_external(::std::forward<Event>(evt),
+                ::std::is_same< mutex_type, ::afsm::none >{});
+    }
+    template < typename Event >
+    void
+    process_external(Event&& evt, ::std::false_type const&)
+    {
+        fsm_type::process_event(::std::forward<Event>(evt));
+    }
+    template < typename Event >
+    void
+    process_external(Event&& evt, ::std::true_type const&)
+    {
+        using event_type = typename ::std::decay<Event>::type;
+        auto _this = fsm_type::shared_from_this();
+        auto e = ::std::make_shared< event_type >(::std::forward<Event>(evt));
+        fsm_type::io_service()->dispatch(
+        [_this, e]()
+        {
+            _this->fsm_type::process_event(::std::move(*e));
+        });
     }
 private:
     connection_callbacks            callbacks_;
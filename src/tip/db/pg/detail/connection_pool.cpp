@@ -7,6 +7,13 @@
 
 #include <tip/db/pg/detail/connection_pool.hpp>
 #include <tip/db/pg/detail/basic_connection.hpp>
+#include <tip/db/pg/detail/handoff_queue.hpp>
+#include <tip/db/pg/detail/atomic_histogram.hpp>
+#include <tip/db/pg/detail/resolver_cache.hpp>
+#include <tip/db/pg/detail/scram.hpp>
+#ifdef WITH_SSL
+#include <tip/db/pg/detail/ssl_transport.hpp>
+#endif
 #include <tip/db/pg/transaction.hpp>
 #include <tip/db/pg/common.hpp>
 #include <tip/db/pg/error.hpp>
@@ -16,9 +23,11 @@
 #include <stdexcept>
 #include <algorithm>
 #include <vector>
-#include <queue>
 #include <mutex>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <random>
 
 namespace tip {
 namespace db {
@@ -27,46 +36,128 @@ namespace detail {
 
 LOCAL_LOGGING_FACILITY_CFG(PGPOOL, config::CONNECTION_LOG);
 
+struct connection_pool::connection_info {
+    using clock_type    = ::std::chrono::steady_clock;
+    using time_point    = clock_type::time_point;
+
+    time_point  created     = clock_type::now();
+    time_point  idle_since  = clock_type::now();
+    /**
+     * Connection didn't become ready yet. Cleared from connection callbacks
+     * that can run on different threads, so it is atomic.
+     */
+    ::std::atomic< bool > connecting{ true };
+};
+
+namespace {
+
+/**
+ * A host that failed or was rejected is tried only when no other host is
+ * left, for that long
+ */
+const ::std::chrono::seconds HOST_AVOID_TIME{10};
+/** Delay before connecting again after all hosts failed */
+const ::std::chrono::milliseconds RECONNECT_DELAY{500};
+
+}  // namespace
+
 struct connection_pool::impl {
+    using clock_type            = connection_info::clock_type;
+    using duration              = pool_options::duration;
+
+    struct idle_connection {
+        connection_ptr          conn;
+        connection_info_ptr     info;
+    };
+    struct waiting_request {
+        events::begin           evt;
+        clock_type::time_point  enqueued;
+    };
+    struct host_state {
+        ::std::string           host;
+        clock_type::time_point  avoid_until;
+    };
     using connections_container = ::std::vector<connection_ptr>;
-    using connections_queue     = ::std::queue<connection_ptr>;
-
-    using request_callbacks_queue = ::std::queue< events::begin >;
+    using hosts_container       = ::std::vector<host_state>;
+    using handoff_type          = handoff_queue< idle_connection, waiting_request,
+                                        TRANSACTION_PRIORITIES >;
 
     using mutex_type            = ::std::recursive_mutex;
     using lock_type             = ::std::lock_guard<mutex_type>;
 
     using atomic_flag           = ::std::atomic_bool;
+    using atomic_counter        = ::std::atomic<size_t>;
 
     io_service_ptr          service_;
-    size_t                  pool_size_;
+    pool_options            options_;
     connection_options      co_;
     client_options_type     params_;
+    /** Host addresses, SCRAM keys and TLS sessions of the connections */
+    connection_caches       caches_;
 
-    mutex_type              event_mutex_;
-    mutex_type              conn_mutex_;
-
+    mutable mutex_type      conn_mutex_;
     connections_container   connections_;
-    connections_queue       ready_connections_;
-
-    request_callbacks_queue queue_;
+    /** Hosts of a multi-host uri, guarded by conn_mutex_ */
+    hosts_container         hosts_;
+    ::std::minstd_rand      random_;
+    /** Number of connections, including the ones being established */
+    atomic_counter          connections_count_;
+    /** Number of connections being established */
+    atomic_counter          connecting_count_;
+
+    /**
+     * Idle connections and requests waiting for a connection, a lane per
+     * transaction priority
+     */
+    handoff_type            handoff_;
+    asio_config::steady_timer reap_timer_;
+    /** Connecting is delayed after all hosts failed */
+    atomic_flag             backoff_;
+    asio_config::steady_timer retry_timer_;
 
     atomic_flag             closed_;
     simple_callback         closed_callback_;
 
+    //@{
+    /** @name Metrics */
+    using metrics_counter   = ::std::atomic< pool_metrics::counter_type >;
+
+    clock_type::time_point  started_;
+    metrics_counter         acquired_;
+    metrics_counter         connections_created_;
+    metrics_counter         connections_closed_;
+    metrics_counter         connection_errors_;
+    atomic_histogram        acquire_wait_;
+    //@}
+
     impl(io_service_ptr service,
-        size_t pool_size,
+        pool_options const& po,
         connection_options const& co,
         client_options_type const& params)
     : service_(service),
-      pool_size_(pool_size),
+      options_(po),
       co_(co),
       params_(params),
-      closed_(false)
+      connections_count_(0),
+      connecting_count_(0),
+      handoff_(po.priority_weights),
+      reap_timer_(*service),
+      backoff_(false),
+      retry_timer_(*service),
+      closed_(false),
+      started_(clock_type::now()),
+      acquired_(0),
+      connections_created_(0),
+      connections_closed_(0),
+      connection_errors_(0)
     {
-        if (pool_size_ == 0)
+        if (options_.max_size == 0)
             throw error::connection_error("Database connection pool size cannot be zero");
 
+        if (options_.min_idle > options_.max_size)
+            throw error::connection_error("Database connection pool minimum idle "
+                    "connections cannot exceed the pool size");
+
         if (co_.uri.empty())
             throw error::connection_error("No URI in database connection string");
 
@@ -75,101 +166,180 @@ struct connection_pool::impl {
 
         if (co_.user.empty())
             throw error::connection_error("No user name in database connection string");
-        local_log() << "Connection pool max size " << pool_size;
+        for (auto const& h : co_.hosts()) {
+            hosts_.push_back({ h, clock_type::time_point{} });
+        }
+        if ((co_.schema == "tcp" || co_.schema == "ssl") &&
+                co_.tcp.dns_cache_ttl > tcp_options::seconds::zero()) {
+            caches_.dns = ::std::make_shared< resolver_cache >(co_.tcp.dns_cache_ttl);
+        }
+        caches_.scram = ::std::make_shared< scram_key_cache >();
+#ifdef WITH_SSL
+        if (co_.schema == "ssl")
+            caches_.tls = ::std::make_shared< tls_session_cache >(co_);
+#endif
+        random_.seed(::std::random_device{}());
+        local_log() << "Connection pool max size " << options_.max_size
+                << " min idle " << options_.min_idle;
     }
 
     dbalias const&
     alias() const
     { return co_.alias; }
 
+    size_t
+    busy() const
+    {
+        size_t total = connections_count_;
+        size_t free = handoff_.idle() + connecting_count_;
+        return total > free ? total - free : 0;
+    }
+
     //@{
     /** @name Connection granular work */
+    /**
+     * Reserve a slot for a new connection
+     * @return false if the pool is full
+     */
     bool
-    get_idle_connection(connection_ptr& conn)
+    reserve_connection()
     {
-        if (closed_)
-            return false;
-        lock_type lock{conn_mutex_};
-        if (!ready_connections_.empty()) {
-            conn = ready_connections_.front();
-            ready_connections_.pop();
-            return true;
+        size_t count = connections_count_.load();
+        while (count < options_.max_size) {
+            if (connections_count_.compare_exchange_weak(count, count + 1))
+                return true;
         }
         return false;
     }
     void
-    add_idle_connection(connection_ptr conn)
-    {
-        if (!closed_) {
-            lock_type lock{conn_mutex_};
-            ready_connections_.push(conn);
-            local_log() << alias() << " idle connections " << ready_connections_.size();
-        }
-    }
-    void
-    erase_connection(connection_ptr conn)
+    erase_connection(connection_ptr conn, connection_info_ptr info)
     {
         local_log() << "Erase connection from the connection pool";
+        if (info->connecting.exchange(false)) {
+            --connecting_count_;
+        }
         lock_type lock{conn_mutex_};
         auto f = std::find(connections_.begin(), connections_.end(), conn);
         if (f != connections_.end()) {
             connections_.erase(f);
+            --connections_count_;
+            ++connections_closed_;
         }
     }
+    bool
+    lifetime_expired(connection_info const& info,
+            connection_info::time_point now = clock_type::now()) const
+    {
+        return options_.max_lifetime != duration::zero() &&
+                now - info.created >= options_.max_lifetime;
+    }
+    bool
+    idle_expired(connection_info const& info,
+            connection_info::time_point now = clock_type::now()) const
+    {
+        return options_.max_idle_time != duration::zero() &&
+                now - info.idle_since >= options_.max_idle_time;
+    }
     //@}
 
     //@{
-    /** @name Event queue */
+    /** @name Host failover */
+    /**
+     * Connection options for a new connection, with the hosts that didn't
+     * fail recently in the uri. Hosts are ordered as listed or shuffled.
+     */
+    connection_options
+    attempt_options()
+    {
+        auto now = clock_type::now();
+        ::std::vector< ::std::string > candidates;
+        ::std::vector< ::std::string > avoided;
+        connection_options co = co_;
+        lock_type lock{conn_mutex_};
+        for (auto const& h : hosts_) {
+            (h.avoid_until > now ? avoided : candidates).push_back(h.host);
+        }
+        if (candidates.empty())
+            candidates.swap(avoided);
+        if (co_.random_host_order)
+            ::std::shuffle(candidates.begin(), candidates.end(), random_);
+        co.uri.clear();
+        for (auto const& h : candidates) {
+            if (!co.uri.empty())
+                co.uri.push_back(',');
+            co.uri += h;
+        }
+        return co;
+    }
+    /**
+     * Mark the host as failed
+     * @return true if there are other hosts to fail over to
+     */
     bool
-    next_event(events::begin& evt)
+    avoid_host(::std::string const& host)
     {
-        namespace util = ::psst::util;
-        lock_type lock{event_mutex_};
-        if (!queue_.empty()) {
-            local_log()
-                    << (util::CLEAR) << (util::RED | util::BRIGHT)
-                    << alias()
-                    << logger::severity_color()
-                    << " queue size " << queue_.size() << " (dequeue)";
-            evt = queue_.front();
-            queue_.pop();
-            return true;
+        auto now = clock_type::now();
+        bool other_hosts = false;
+        lock_type lock{conn_mutex_};
+        for (auto& h : hosts_) {
+            if (h.host == host) {
+                h.avoid_until = now + HOST_AVOID_TIME;
+            } else if (h.avoid_until <= now) {
+                other_hosts = true;
+            }
         }
-        return false;
+        return other_hosts;
     }
+    /**
+     * Stop connecting for a while, all hosts failed
+     */
     void
-    enqueue_event(events::begin&& evt)
+    start_backoff(connection_pool_ptr pool)
     {
-        namespace util = ::psst::util;
-        lock_type lock{event_mutex_};
-        queue_.push(::std::move(evt));
-
-        local_log()
-                << (util::CLEAR) << (util::RED | util::BRIGHT)
-                << alias()
-                << logger::severity_color()
-                << " queue size " << queue_.size() << " (enqueue)";
+        backoff_ = true;
+        retry_timer_.expires_from_now(RECONNECT_DELAY);
+        retry_timer_.async_wait(
+        [pool](asio_config::error_code const& ec)
+        {
+            if (!ec) {
+                pool->pimpl_->backoff_ = false;
+                pool->pimpl_->replenish(pool);
+            }
+        });
     }
+    //@}
+
+    //@{
+    /** @name Event queue */
     void
     clear_queue(error::connection_error const& ec)
     {
-        lock_type lock(event_mutex_);
-        while (!queue_.empty()) {
-            auto req = queue_.front();
-            queue_.pop();
-            if (req.error) {
-                req.error(ec);
+        waiting_request req;
+        while (handoff_.take_request(req)) {
+            if (req.evt.error) {
+                req.evt.error(ec);
             }
         }
     }
+    /**
+     * Start a transaction for the request on the connection
+     */
+    void
+    dispatch(connection_ptr c, waiting_request&& req)
+    {
+        acquire_wait_.record(::std::chrono::duration_cast< latency_histogram::duration >(
+                clock_type::now() - req.enqueued));
+        ++acquired_;
+        c->begin(::std::move(req.evt));
+    }
     //@}
 
-    void
+    bool
     create_new_connection(connection_pool_ptr pool)
     {
         namespace util = ::psst::util;
-        if (closed_)
-            return;
+        if (closed_ || !reserve_connection())
+            return false;
         {
             local_log(logger::INFO)
                     << "Create new "
@@ -178,16 +348,19 @@ struct connection_pool::impl {
                     << logger::severity_color()
                     << " connection";
         }
+        ++connecting_count_;
+        ++connections_created_;
+        connection_info_ptr info = ::std::make_shared<connection_info>();
         connection_ptr conn = basic_connection::create(
-            service_, co_, params_,
+            service_, attempt_options(), params_,
             {
-                [pool](connection_ptr c)
-                { pool->connection_ready(c); },
-                [pool](connection_ptr c)
-                { pool->connection_terminated(c); },
-                [pool](connection_ptr c, error::connection_error const& ec)
-                { pool->connection_error(c, ec); }
-            });
+                [pool, info](connection_ptr c)
+                { pool->connection_ready(c, info); },
+                [pool, info](connection_ptr c)
+                { pool->connection_terminated(c, info); },
+                [pool, info](connection_ptr c, error::connection_error const& ec)
+                { pool->connection_error(c, info, ec); }
+            }, caches_);
 
         {
             lock_type lock{conn_mutex_};
@@ -199,10 +372,106 @@ struct connection_pool::impl {
                 << logger::severity_color()
                 << " pool size " << connections_.size();
         }
+        return true;
+    }
+
+    /**
+     * Open connections for the waiting requests and to keep min_idle idle
+     * connections. The connections are opened in parallel.
+     */
+    void
+    replenish(connection_pool_ptr pool)
+    {
+        while (!closed_ && !backoff_ &&
+                static_cast<size_t>(handoff_.idle()) + connecting_count_ <
+                    options_.min_idle + static_cast<size_t>(handoff_.waiting())) {
+            if (!create_new_connection(pool))
+                break;
+        }
+    }
+
+    //@{
+    /** @name Idle connection reaping */
+    duration
+    reap_interval() const
+    {
+        duration interval = duration::zero();
+        for (auto d : { options_.max_idle_time, options_.max_lifetime }) {
+            if (d != duration::zero() &&
+                    (interval == duration::zero() || d < interval))
+                interval = d;
+        }
+        return interval == duration::zero() ? interval :
+                ::std::max(interval / 2, duration{10});
+    }
+
+    void
+    schedule_reap(connection_pool_ptr pool)
+    {
+        duration interval = reap_interval();
+        if (closed_ || interval == duration::zero())
+            return;
+        reap_timer_.expires_from_now(interval);
+        reap_timer_.async_wait(
+        [pool](asio_config::error_code const& ec)
+        {
+            if (!ec)
+                pool->pimpl_->reap(pool);
+        });
     }
 
+    /**
+     * Close idle connections that exceeded their lifetime, and idle
+     * connections that were idle for too long while more than min_idle
+     * connections stay idle. Connections closed for their lifetime are
+     * replaced up to min_idle when they terminate.
+     */
     void
-    connection_ready(connection_ptr c)
+    reap(connection_pool_ptr pool)
+    {
+        if (closed_)
+            return;
+        auto now = clock_type::now();
+        ::std::vector<idle_connection> idle;
+        idle_connection ic;
+        // Most recently used connections come first
+        while (handoff_.take_idle(ic)) {
+            idle.push_back(::std::move(ic));
+        }
+        size_t alive = ::std::count_if(idle.begin(), idle.end(),
+            [&](idle_connection const& c)
+            { return !lifetime_expired(*c.info, now); });
+        size_t closed_count = 0;
+        ::std::vector<idle_connection> keep;
+        for (auto& c : idle) {
+            bool close = lifetime_expired(*c.info, now);
+            if (!close && alive > options_.min_idle && idle_expired(*c.info, now)) {
+                close = true;
+                --alive;
+            }
+            if (close) {
+                c.conn->terminate();
+                ++closed_count;
+            } else {
+                keep.push_back(::std::move(c));
+            }
+        }
+        for (auto c = keep.rbegin(); c != keep.rend(); ++c) {
+            waiting_request req;
+            if (handoff_.release(*c, req)) {
+                dispatch(c->conn, ::std::move(req));
+            }
+        }
+        if (closed_count) {
+            local_log() << alias() << " closed " << closed_count
+                    << " idle connections";
+        }
+        schedule_reap(pool);
+    }
+    //@}
+
+    void
+    connection_ready(connection_ptr c, connection_info_ptr info)
     {
         namespace util = ::psst::util;
         {
@@ -213,21 +482,37 @@ struct connection_pool::impl {
                 << logger::severity_color()
                 << " ready";
         }
+        if (info->connecting.exchange(false)) {
+            --connecting_count_;
+        }
+        if (!closed_ && lifetime_expired(*info)) {
+            local_log() << "Connection " << alias() << " reached max lifetime";
+            c->terminate();
+            return;
+        }
 
-        events::begin evt;
-        if (next_event(evt)) {
-            c->begin(::std::move(evt));
+        info->idle_since = clock_type::now();
+        waiting_request req;
+        idle_connection ic{ c, info };
+        if (handoff_.release(ic, req)) {
+            local_log()
+                    << (util::CLEAR) << (util::RED | util::BRIGHT)
+                    << alias()
+                    << logger::severity_color()
+                    << " queue size " << handoff_.waiting() << " (dequeue)";
+            // Not necessarily c, the most recently used idle connection
+            dispatch(ic.conn, ::std::move(req));
         } else {
+            local_log() << alias() << " idle connections " << handoff_.idle();
             if (closed_) {
                 close_connections();
-            } else {
-                add_idle_connection(c);
             }
         }
     }
 
     void
-    connection_terminated(connection_ptr c)
+    connection_terminated(connection_ptr c, connection_info_ptr info,
+            connection_pool_ptr pool)
     {
         namespace util = ::psst::util;
         {
@@ -239,9 +524,9 @@ struct connection_pool::impl {
                     << " gracefully terminated";
         }
         {
-            erase_connection(c);
+            erase_connection(c, info);
 
-            if (connections_.empty() && closed_ && closed_callback_) {
+            if (connections_count_ == 0 && closed_ && closed_callback_) {
                 closed_callback_();
             }
         }
@@ -251,44 +536,97 @@ struct connection_pool::impl {
                 << (util::CLEAR) << (util::RED | util::BRIGHT)
                 << alias()
                 << logger::severity_color()
-                << " pool size " << connections_.size();
+                << " pool size " << connections_count_;
         }
+        replenish(pool);
     }
 
+    /**
+     * A broken established connection is replaced when it terminates, the
+     * waiting requests are kept. When a new connection fails, the waiting
+     * requests are kept as long as there are other hosts to fail over to.
+     */
     void
-    connection_error(connection_ptr c, error::connection_error const& ec)
+    connection_error(connection_ptr c, connection_info_ptr info,
+            error::connection_error const& ec, connection_pool_ptr pool)
     {
         local_log(logger::ERROR) << "Connection " << alias() << " error: "
                 << ec.what();
-        erase_connection(c);
+        ++connection_errors_;
+        bool connecting = info->connecting;
+        erase_connection(c, info);
+        if (!connecting)
+            return;
+        if (c && !c->host().empty() && avoid_host(c->host())) {
+            local_log(logger::WARNING) << alias() << " fail over from "
+                    << c->host() << ", " << handoff_.waiting()
+                    << " requests keep waiting";
+            return;
+        }
+        start_backoff(pool);
         clear_queue(ec);
     }
 
     void
-    get_connection(transaction_callback const& conn_cb,
-        error_callback const& err,
-        transaction_mode const& mode,
-        connection_pool_ptr pool)
+    get_connection(events::begin&& evt, connection_pool_ptr pool)
     {
         namespace util = ::psst::util;
         if (closed_) {
-            err( error::connection_error("Connection pool is closed") );
+            if (evt.error)
+                evt.error( error::connection_error("Connection pool is closed") );
             return;
         }
-        connection_ptr conn;
-        if (get_idle_connection(conn)) {
+        ::std::size_t lane = static_cast< ::std::size_t >(evt.mode.priority);
+        waiting_request req{ ::std::move(evt), clock_type::now() };
+        idle_connection ic;
+        if (handoff_.acquire(req, ic, lane)) {
             local_log() << "Connection to "
                     << (util::CLEAR) << (util::RED | util::BRIGHT)
                     << alias()
                     << logger::severity_color()
                     << " is idle";
-            conn->begin({conn_cb, err, mode});
+            dispatch(ic.conn, ::std::move(req));
         } else {
-            if (!closed_ && connections_.size() < pool_size_) {
-                create_new_connection(pool);
-            }
-            enqueue_event({conn_cb, err, mode});
+            local_log()
+                    << (util::CLEAR) << (util::RED | util::BRIGHT)
+                    << alias()
+                    << logger::severity_color()
+                    << " queue size " << handoff_.waiting() << " (enqueue)";
         }
+        replenish(pool);
+    }
+
+    pool_metrics
+    metrics() const
+    {
+        pool_metrics m;
+        m.alias         = alias();
+        m.uri           = co_.uri;
+        m.role          = co_.role;
+        m.uptime        = ::std::chrono::duration_cast< pool_metrics::duration >(
+                                clock_type::now() - started_);
+        m.max_size      = options_.max_size;
+        m.idle          = handoff_.idle();
+        m.connecting    = connecting_count_;
+        m.queue_depth   = handoff_.waiting();
+        m.busy          = busy();
+
+        m.acquired              = acquired_;
+        m.connections_created   = connections_created_;
+        m.connections_closed    = connections_closed_;
+        m.connection_errors     = connection_errors_;
+        m.acquire_wait          = acquire_wait_.snapshot();
+
+        connections_container copy;
+        {
+            lock_type lock{conn_mutex_};
+            copy = connections_;
+        }
+        m.connections.reserve(copy.size());
+        for (auto const& c : copy) {
+            m.connections.push_back(c->metrics());
+        }
+        return m;
     }
 
     void
@@ -297,9 +635,10 @@ struct connection_pool::impl {
         bool expected = false;
         if (closed_.compare_exchange_strong(expected, true)) {
             closed_callback_ = close_cb;
+            reap_timer_.cancel();
+            retry_timer_.cancel();
 
-            lock_type lock{event_mutex_};
-            if (queue_.empty()) {
+            if (handoff_.waiting() == 0) {
                 close_connections();
             } else {
                 local_log() << "Wait for outstanding tasks to finish";
@@ -315,10 +654,13 @@ struct connection_pool::impl {
                 << (util::CLEAR) << (util::RED | util::BRIGHT)
                 << alias()
                 << logger::severity_color()
-                << " pool size " << connections_.size();
-        if (connections_.size() > 0) {
+                << " pool size " << connections_count_;
+        connections_container copy;
+        {
             lock_type lock(conn_mutex_);
-            connections_container copy = connections_;
+            copy = connections_;
+        }
+        if (!copy.empty()) {
             for ( auto c : copy ) {
                 c->terminate();
             }
@@ -329,10 +671,10 @@ struct connection_pool::impl {
 };
 
 connection_pool::connection_pool(io_service_ptr service,
-        size_t pool_size,
+        pool_options const& po,
         connection_options const& co,
         client_options_type const& params)
-    : pimpl_(new impl(service, pool_size, co, params))
+    : pimpl_(new impl(service, po, co, params))
 {
 }
 
@@ -347,48 +689,85 @@ connection_pool::alias() const
     return pimpl_->alias();
 }
 
+connection_options const&
+connection_pool::options() const
+{
+    return pimpl_->co_;
+}
+
+size_t
+connection_pool::outstanding() const
+{
+    return pimpl_->handoff_.waiting() + pimpl_->busy();
+}
+
 connection_pool::connection_pool_ptr
 connection_pool::create(io_service_ptr service,
         size_t pool_size,
         connection_options const& co,
         client_options_type const& params)
 {
-    connection_pool_ptr pool(new connection_pool( service, pool_size, co, params ));
-    pool->create_new_connection();
+    return create(service, pool_options{pool_size}, co, params);
+}
+
+connection_pool::connection_pool_ptr
+connection_pool::create(io_service_ptr service,
+        pool_options const& po,
+        connection_options const& co,
+        client_options_type const& params)
+{
+    connection_pool_ptr pool(new connection_pool( service, po, co, params ));
+    pool->start();
     return pool;
 }
 
 void
-connection_pool::create_new_connection()
+connection_pool::start()
 {
     auto _this = shared_from_this();
-    pimpl_->create_new_connection(_this);
+    pimpl_->replenish(_this);
+    pimpl_->schedule_reap(_this);
 }
 
 void
-connection_pool::connection_ready(connection_ptr c)
+connection_pool::connection_ready(connection_ptr c, connection_info_ptr info)
 {
-    pimpl_->connection_ready(c);
+    pimpl_->connection_ready(c, info);
 }
 
 void
-connection_pool::connection_terminated(connection_ptr c)
+connection_pool::connection_terminated(connection_ptr c, connection_info_ptr info)
 {
-    pimpl_->connection_terminated(c);
+    auto _this = shared_from_this();
+    pimpl_->connection_terminated(c, info, _this);
 }
 
 void
-connection_pool::connection_error(connection_ptr c, error::connection_error const& ec)
+connection_pool::connection_error(connection_ptr c, connection_info_ptr info,
+        error::connection_error const& ec)
 {
-    pimpl_->connection_error(c, ec);
+    auto _this = shared_from_this();
+    pimpl_->connection_error(c, info, ec, _this);
 }
 
 void
 connection_pool::get_connection(transaction_callback const& conn_cb,
         error_callback const& err, transaction_mode const& mode)
+{
+    get_connection(events::begin{conn_cb, err, mode});
+}
+
+void
+connection_pool::get_connection(events::begin&& evt)
 {
     auto _this = shared_from_this();
-    pimpl_->get_connection(conn_cb, err, mode, _this);
+    pimpl_->get_connection(::std::move(evt), _this);
+}
+
+pool_metrics
+connection_pool::metrics() const
+{
+    return pimpl_->metrics();
 }
 
 void
@@ -34,31 +34,52 @@ public:
     create(io_service_ptr service, size_t pool_size,
             connection_options const& co,
             client_options_type const& = client_options_type());
+    static connection_pool_ptr
+    create(io_service_ptr service, pool_options const& po,
+            connection_options const& co,
+            client_options_type const& = client_options_type());
 
     ~connection_pool();
 
     dbalias const&
     alias() const;
+    connection_options const&
+    options() const;
+
+    /**
+     * Number of requests waiting for a connection or running a transaction
+     */
+    size_t
+    outstanding() const;
 
     void
     get_connection(transaction_callback const&, error_callback const&,
             transaction_mode const&);
+    void
+    get_connection(events::begin&&);
+
+    pool_metrics
+    metrics() const;
 
     void
     close(simple_callback);
 private:
-    connection_pool(io_service_ptr service, size_t pool_size,
+    struct connection_info;
+    using connection_info_ptr   = ::std::shared_ptr<connection_info>;
+
+    connection_pool(io_service_ptr service, pool_options const& po,
             connection_options const& co,
             client_options_type const&);
 
     void
-    create_new_connection();
+    start();
     void
-    connection_ready(connection_ptr c);
+    connection_ready(connection_ptr c, connection_info_ptr info);
     void
-    connection_terminated(connection_ptr c);
+    connection_terminated(connection_ptr c, connection_info_ptr info);
     void
-    connection_error(connection_ptr c, error::connection_error const& ec);
+    connection_error(connection_ptr c, connection_info_ptr info,
+            error::connection_error const& ec);
 
     void
     close_connections();
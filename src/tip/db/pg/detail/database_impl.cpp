@@ -7,8 +7,11 @@
 
 #include <tip/db/pg/detail/database_impl.hpp>
 #include <tip/db/pg/detail/connection_pool.hpp>
+#include <tip/db/pg/detail/service_runner.hpp>
 #include <tip/db/pg/error.hpp>
 #include <stdexcept>
+#include <algorithm>
+#include <thread>
 
 #include <tip/db/pg/log.hpp>
 
@@ -19,12 +22,21 @@ namespace detail {
 
 LOCAL_LOGGING_FACILITY_CFG(PGDB, config::SERVICE_LOG);
 
-database_impl::database_impl(size_t pool_size, client_options_type const& defaults)
-    : service_( std::make_shared<asio_config::io_service>() ),
-      pool_size_(pool_size), defaults_(defaults),
+namespace {
+
+/** Database service and shard run by the calling thread */
+thread_local database_impl const*   current_db      = nullptr;
+thread_local size_t                 current_shard_n = 0;
+
+}  // namespace
+
+database_impl::database_impl(pool_options const& po, client_options_type const& defaults,
+        size_t shards)
+    : next_shard_(0), pool_defaults_(po), defaults_(defaults),
       state_(running)
 {
     local_log() << "Initializing postgre db service";
+    create_shards(shards);
 }
 
 database_impl::~database_impl()
@@ -33,12 +45,74 @@ database_impl::~database_impl()
 }
 
 void
-database_impl::set_defaults(size_t pool_size, client_options_type const& defaults)
+database_impl::set_defaults(pool_options const& po, client_options_type const& defaults,
+        size_t shards)
 {
-    pool_size_ = pool_size;
+    if (shards == 0)
+        shards = ::std::max(::std::thread::hardware_concurrency(), 1u);
+    if (shards != shards_.size()) {
+        for (auto const& s : shards_) {
+            if (!s->connections.empty())
+                throw error::connection_error("Cannot change the number of "
+                        "shards after connections are registered");
+        }
+        create_shards(shards);
+    }
+    pool_defaults_ = po;
     defaults_ = defaults;
 }
 
+void
+database_impl::create_shards(size_t count)
+{
+    if (count == 0)
+        count = ::std::max(::std::thread::hardware_concurrency(), 1u);
+    local_log() << "Create " << count << " shard(s)";
+    shards_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        shard_ptr s(new shard);
+        // A shard service is run by a single thread
+        s->service = count > 1 ?
+                std::make_shared<asio_config::io_service>(1) :
+                std::make_shared<asio_config::io_service>();
+        shards_.push_back(::std::move(s));
+    }
+}
+
+asio_config::io_service_ptr
+database_impl::io_service()
+{
+    if (current_db == this)
+        return shards_[current_shard_n]->service;
+    return shards_.front()->service;
+}
+
+asio_config::io_service_ptr
+database_impl::io_service(size_t n)
+{
+    if (n >= shards_.size())
+        throw error::db_error("Shard number is out of range");
+    return shards_[n]->service;
+}
+
+db_service::optional_size
+database_impl::current_shard() const
+{
+    if (current_db == this)
+        return current_shard_n;
+    return db_service::optional_size{};
+}
+
+database_impl::shard&
+database_impl::select_shard()
+{
+    if (current_db == this)
+        return *shards_[current_shard_n];
+    if (shards_.size() == 1)
+        return *shards_.front();
+    return *shards_[next_shard_++ % shards_.size()];
+}
+
 void
 database_impl::add_connection(std::string const& connection_string,
         db_service::optional_size pool_size,
@@ -54,6 +128,19 @@ void
 database_impl::add_connection(connection_options co,
         db_service::optional_size pool_size,
         client_options_type const& params)
+{
+    pool_options po = pool_defaults_;
+    if (pool_size.is_initialized()) {
+        po.max_size = *pool_size;
+        po.min_idle = ::std::min(po.min_idle, po.max_size);
+    }
+    add_connection(co, po, params);
+}
+
+void
+database_impl::add_connection(connection_options co,
+        pool_options const& po,
+        client_options_type const& params)
 {
     if (state_ != running)
         throw error::connection_error("Database service is not running");
@@ -71,55 +158,191 @@ database_impl::add_connection(connection_options co,
         co.generate_alias();
     }
 
-    add_pool(co, pool_size, params);
+    for (auto& s : shards_) {
+        add_pool(*s, co, po, params);
+    }
+}
+
+database_impl::pools_list
+database_impl::host_group::pools() const
+{
+    pools_list res;
+    if (primary)
+        res.push_back(primary);
+    res.insert(res.end(), replicas.begin(), replicas.end());
+    return res;
 }
 
 database_impl::connection_pool_ptr
-database_impl::add_pool(connection_options const& co,
-        db_service::optional_size pool_size,
+database_impl::add_pool(shard& s, connection_options const& co,
+        pool_options const& po,
         client_options_type const& params)
 {
-    if (!connections_.count(co.alias)) {
-        if (!pool_size.is_initialized()) {
-            pool_size = pool_size_;
+    auto f = s.connections.find(co.alias);
+    if (f != s.connections.end()) {
+        host_group const& group = f->second;
+        if (co.role == host_role::primary && group.primary)
+            return group.primary;
+        for (auto const& r : group.replicas) {
+            if (co.role == host_role::replica && r->options().uri == co.uri)
+                return r;
+        }
+    }
+
+    local_log(logger::INFO) << "Create a new connection pool " << co.alias
+            << " " << co.role << " size " << po.max_size;
+    client_options_type parms(params);
+    for (auto p : defaults_) {
+        if (!parms.count(p.first)) {
+            parms.insert(p);
         }
-        local_log(logger::INFO) << "Create a new connection pool " << co.alias
-                << " size " << *pool_size;
-        client_options_type parms(params);
-        for (auto p : defaults_) {
-            if (!parms.count(p.first)) {
-                parms.insert(p);
+    }
+    local_log(logger::INFO) << "Register new connection " << co.uri
+            << "[" << co.database << "]" << " with alias " << co.alias;
+    connection_pool_ptr pool(connection_pool::create(s.service, po, co, parms));
+    host_group& group = s.connections[co.alias];
+    if (co.role == host_role::primary) {
+        group.primary = pool;
+    } else {
+        group.replicas.push_back(pool);
+    }
+    return pool;
+}
+
+database_impl::connection_pool_ptr
+database_impl::select_pool(shard& s, dbalias const& alias,
+        transaction_mode const& mode)
+{
+    auto f = s.connections.find(alias);
+    if (f == s.connections.end()) {
+        throw error::connection_error("Database alias '" + alias + "' is not registered");
+    }
+    host_group& group = f->second;
+    if (mode.read_only && !group.replicas.empty()) {
+        // Least outstanding requests, ties are broken round-robin
+        size_t count = group.replicas.size();
+        size_t start = group.next_replica++ % count;
+        connection_pool_ptr best;
+        size_t best_load = 0;
+        for (size_t i = 0; i < count; ++i) {
+            connection_pool_ptr const& pool = group.replicas[(start + i) % count];
+            size_t load = pool->outstanding();
+            if (!best || load < best_load) {
+                best = pool;
+                best_load = load;
             }
         }
-        local_log(logger::INFO) << "Register new connection " << co.uri
-                << "[" << co.database << "]" << " with alias " << co.alias;
-        connections_.insert(std::make_pair(co.alias,
-                connection_pool_ptr(connection_pool::create(service_,
-                        *pool_size, co, parms) )));
+        return best;
+    }
+    if (!group.primary) {
+        throw error::connection_error("Database alias '" + alias +
+                "' has no primary host for a read-write transaction");
     }
-    return connections_[co.alias];
+    return group.primary;
 }
 
 void
-database_impl::get_connection(dbalias const& alias,
-        transaction_callback const& cb,
-        error_callback const& err,
-        transaction_mode const& mode)
+database_impl::get_connection(dbalias const& alias, events::begin&& evt)
 {
     if (state_ != running)
         throw error::connection_error("Database service is not running");
 
-    if (!connections_.count(alias)) {
+    connection_pool_ptr pool = select_pool(select_shard(), alias, evt.mode);
+    pool->get_connection(::std::move(evt));
+}
+
+pool_metrics
+database_impl::metrics(dbalias const& alias) const
+{
+    shard const& s = current_db == this ?
+            *shards_[current_shard_n] : *shards_.front();
+    auto f = s.connections.find(alias);
+    if (f == s.connections.end()) {
         throw error::connection_error("Database alias '" + alias + "' is not registered");
     }
-    connection_pool_ptr pool = connections_[alias];
-    pool->get_connection(cb, err, mode);
+    return f->second.pools().front()->metrics();
+}
+
+std::vector< pool_metrics >
+database_impl::metrics() const
+{
+    std::vector< pool_metrics > res;
+    for (size_t n = 0; n < shards_.size(); ++n) {
+        for (auto const& c : shards_[n]->connections) {
+            for (auto const& pool : c.second.pools()) {
+                res.push_back(pool->metrics());
+                res.back().shard = n;
+            }
+        }
+    }
+    return res;
 }
 
 void
 database_impl::run()
 {
-    service_->run();
+    if (runner_) {
+        runner_->join();
+        return;
+    }
+    if (shards_.size() == 1) {
+        run_shard(0);
+        return;
+    }
+    ::std::vector< ::std::thread > threads;
+    threads.reserve(shards_.size() - 1);
+    for (size_t n = 1; n < shards_.size(); ++n) {
+        threads.emplace_back(&database_impl::run_shard, this, n);
+    }
+    run_shard(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void
+database_impl::start(runner_options const& opts)
+{
+    if (state_ != running)
+        throw error::connection_error("Database service is not running");
+    if (runner_)
+        throw error::db_error("Database service is already started");
+    service_runner::services_list services;
+    for (auto const& s : shards_) {
+        services.push_back(s->service);
+    }
+    runner_.reset(new service_runner(services, opts,
+            [this](size_t n){ run_shard(n); }));
+    runner_->start(shared_from_this());
+}
+
+void
+database_impl::wait()
+{
+    if (runner_ && !runner_->runner_thread())
+        runner_->join();
+}
+
+std::vector< latency_histogram >
+database_impl::event_loop_lag() const
+{
+    if (runner_)
+        return runner_->lag();
+    return std::vector< latency_histogram >{};
+}
+
+void
+database_impl::run_shard(size_t n)
+{
+    current_db = this;
+    current_shard_n = n;
+    try {
+        shards_[n]->service->run();
+    } catch (...) {
+        current_db = nullptr;
+        throw;
+    }
+    current_db = nullptr;
 }
 
 void
@@ -127,22 +350,41 @@ database_impl::stop()
 {
     if (state_ == running) {
         state_ = closing;
-        std::shared_ptr< size_t > pool_count =
-                std::make_shared< size_t >(connections_.size());
-        asio_config::io_service_ptr svc = service_;
-
-        for (auto c: connections_) {
-            // Pass a close callback. Call stop
-            // only when all connections are closed, may be with some timeout
-            c.second->close(
-            [pool_count, svc](){
-                --(*pool_count);
-                if (*pool_count == 0) {
-                    svc->stop();
-                }
-            });
+        for (auto const& s : shards_) {
+            pools_list pools;
+            for (auto const& c : s->connections) {
+                pools_list group = c.second.pools();
+                pools.insert(pools.end(), group.begin(), group.end());
+            }
+            asio_config::io_service_ptr svc = s->service;
+            if (pools.empty()) {
+                svc->stop();
+                continue;
+            }
+            // Pools are closed and counted on the shard's thread, the
+            // pools and their connections are only touched there
+            std::shared_ptr< size_t > pool_count =
+                    std::make_shared< size_t >(pools.size());
+
+            for (auto c: pools) {
+                svc->post(
+                [c, pool_count, svc](){
+                    // Call stop only when all connections are closed
+                    c->close(
+                    [pool_count, svc](){
+                        svc->post(
+                        [pool_count, svc](){
+                            if (--(*pool_count) == 0) {
+                                svc->stop();
+                            }
+                        });
+                    });
+                });
+            }
+            s->connections.clear();
         }
-        connections_.clear();
+        if (runner_)
+            runner_->drain();
     }
 }
 
@@ -15,6 +15,9 @@
 #include <boost/noncopyable.hpp>
 
 #include <map>
+#include <memory>
+#include <vector>
+#include <atomic>
 
 namespace tip {
 namespace db {
@@ -22,16 +25,42 @@ namespace pg {
 namespace detail {
 
 struct connection_pool;
+class service_runner;
 
-class database_impl : private boost::noncopyable {
+class database_impl : public std::enable_shared_from_this<database_impl>,
+        private boost::noncopyable {
     typedef std::shared_ptr<connection_pool> connection_pool_ptr;
-    typedef std::map<dbalias, connection_pool_ptr> pools_map;
+    typedef std::vector<connection_pool_ptr> pools_list;
+    /**
+     * Connection pools of the hosts registered with an alias
+     */
+    struct host_group {
+        connection_pool_ptr         primary;
+        pools_list                  replicas;
+        /** Replica to start the search of the least loaded one from */
+        std::atomic<size_t>         next_replica{0};
+
+        pools_list
+        pools() const;
+    };
+    typedef std::map<dbalias, host_group> pools_map;
+    /**
+     * An io_service with its own connection pools, run by a single thread
+     */
+    struct shard {
+        asio_config::io_service_ptr service;
+        pools_map                   connections;
+    };
+    typedef std::unique_ptr<shard> shard_ptr;
+    typedef std::vector<shard_ptr> shards_list;
 public:
-    database_impl(size_t pool_size, client_options_type const& defaults);
+    database_impl(pool_options const& po, client_options_type const& defaults,
+            size_t shards = 1);
     virtual ~database_impl();
 
     void
-    set_defaults(size_t pool_size, client_options_type const& defaults);
+    set_defaults(pool_options const& po, client_options_type const& defaults,
+            size_t shards = 1);
 
     void
     add_connection(std::string const& connection_string,
@@ -41,32 +70,68 @@ public:
     add_connection(connection_options options,
             db_service::optional_size pool_size = db_service::optional_size(),
             client_options_type const& params = client_options_type());
+    void
+    add_connection(connection_options options,
+            pool_options const& po,
+            client_options_type const& params = client_options_type());
 
     void
-    get_connection(dbalias const&, transaction_callback const&,
-            error_callback const&, transaction_mode const&);
+    get_connection(dbalias const&, events::begin&&);
+
+    pool_metrics
+    metrics(dbalias const&) const;
+    std::vector< pool_metrics >
+    metrics() const;
 
     void
     run();
+    void
+    start(runner_options const&);
 
     void
     stop();
+    /** Wait for the runner threads to finish, unless called from one */
+    void
+    wait();
+
+    std::vector< latency_histogram >
+    event_loop_lag() const;
 
+    /** Service of the calling thread's shard, or of the first one */
     asio_config::io_service_ptr
-    io_service()
-    {
-        return service_;
-    }
+    io_service();
+    asio_config::io_service_ptr
+    io_service(size_t shard);
+
+    size_t
+    shard_count() const
+    { return shards_.size(); }
+    /** Shard run by the calling thread */
+    db_service::optional_size
+    current_shard() const;
 private:
+    void
+    create_shards(size_t count);
+    void
+    run_shard(size_t n);
+    /**
+     * Shard for a request from the calling thread: its own shard, or the
+     * next one round-robin for a thread that doesn't run a shard.
+     */
+    shard&
+    select_shard();
+
     connection_pool_ptr
-    add_pool(connection_options const&,
-            db_service::optional_size = db_service::optional_size(),
+    add_pool(shard&, connection_options const&, pool_options const&,
             client_options_type const& = {});
+    connection_pool_ptr
+    select_pool(shard&, dbalias const&, transaction_mode const&);
 
-    asio_config::io_service_ptr    service_;
-    size_t                        pool_size_;
+    shards_list                    shards_;
+    std::atomic<size_t>            next_shard_;
+    std::unique_ptr<service_runner> runner_;
+    pool_options                pool_defaults_;
 
-    pools_map                    connections_;
     client_options_type            defaults_;
 
     enum state_type {
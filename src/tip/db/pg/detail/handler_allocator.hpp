@@ -0,0 +1,177 @@
+/*
+ * handler_allocator.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_HANDLER_ALLOCATOR_HPP_
+#define TIP_DB_PG_DETAIL_HANDLER_ALLOCATOR_HPP_
+
+#include <tip/db/pg/asio_config.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * Recycled memory for asynchronous operation handlers.
+ *
+ * Keeps a few fixed-size blocks, an allocation takes a free block if the
+ * size fits and falls back to the heap otherwise. A connection has at most
+ * one outstanding read and a few outstanding writes and notifications, so
+ * in steady state the operations don't allocate.
+ */
+template < ::std::size_t BlockSize = 512, ::std::size_t Blocks = 4 >
+class handler_memory : private boost::noncopyable {
+public:
+    static constexpr ::std::size_t block_size   = BlockSize;
+    static constexpr ::std::size_t blocks       = Blocks;
+public:
+    handler_memory() : block_allocations_{0}, heap_allocations_{0}
+    {
+        for (auto& u : in_use_)
+            u = false;
+    }
+
+    void*
+    allocate(::std::size_t size)
+    {
+        if (size <= BlockSize) {
+            for (::std::size_t i = 0; i < Blocks; ++i) {
+                if (!in_use_[i].exchange(true)) {
+                    ++block_allocations_;
+                    return &storage_[i];
+                }
+            }
+        }
+        ++heap_allocations_;
+        return ::operator new(size);
+    }
+
+    void
+    deallocate(void* p)
+    {
+        for (::std::size_t i = 0; i < Blocks; ++i) {
+            if (p == &storage_[i]) {
+                in_use_[i] = false;
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+    /** Number of allocations served from a block */
+    ::std::size_t
+    block_allocations() const
+    { return block_allocations_; }
+    /** Number of allocations that didn't fit a block */
+    ::std::size_t
+    heap_allocations() const
+    { return heap_allocations_; }
+private:
+    using block_type = typename ::std::aligned_storage< BlockSize >::type;
+
+    ::std::array< block_type, Blocks >          storage_;
+    ::std::array< ::std::atomic<bool>, Blocks > in_use_;
+    ::std::atomic< ::std::size_t >              block_allocations_;
+    ::std::atomic< ::std::size_t >              heap_allocations_;
+};
+
+template < ::std::size_t BlockSize, ::std::size_t Blocks >
+constexpr ::std::size_t handler_memory< BlockSize, Blocks >::block_size;
+template < ::std::size_t BlockSize, ::std::size_t Blocks >
+constexpr ::std::size_t handler_memory< BlockSize, Blocks >::blocks;
+
+/**
+ * Standard allocator over handler_memory, associated with a handler
+ * by custom_alloc_handler.
+ */
+template < typename T, typename Memory >
+class handler_allocator {
+public:
+    using value_type = T;
+
+    explicit
+    handler_allocator(Memory& mem) : memory_(&mem) {}
+
+    template < typename U >
+    handler_allocator(handler_allocator< U, Memory > const& rhs)
+        : memory_(rhs.memory_) {}
+
+    T*
+    allocate(::std::size_t n) const
+    {
+        return static_cast< T* >(memory_->allocate(sizeof(T) * n));
+    }
+
+    void
+    deallocate(T* p, ::std::size_t) const
+    {
+        memory_->deallocate(p);
+    }
+
+    template < typename U >
+    bool
+    operator == (handler_allocator< U, Memory > const& rhs) const
+    { return memory_ == rhs.memory_; }
+    template < typename U >
+    bool
+    operator != (handler_allocator< U, Memory > const& rhs) const
+    { return memory_ != rhs.memory_; }
+private:
+    template < typename, typename > friend class handler_allocator;
+    Memory* memory_;
+};
+
+/**
+ * Handler wrapper making asio allocate the operation from handler_memory.
+ * The memory must outlive the operation.
+ */
+template < typename Handler, typename Memory >
+class custom_alloc_handler {
+public:
+    using allocator_type = handler_allocator< Handler, Memory >;
+
+    custom_alloc_handler(Memory& mem, Handler h)
+        : memory_(mem), handler_(::std::move(h)) {}
+
+    allocator_type
+    get_allocator() const
+    { return allocator_type{memory_}; }
+
+    template < typename ... Args >
+    void
+    operator()(Args&& ... args)
+    {
+        handler_(::std::forward<Args>(args)...);
+    }
+private:
+    Memory&     memory_;
+    Handler     handler_;
+};
+
+template < typename Handler, typename Memory >
+custom_alloc_handler< typename ::std::decay<Handler>::type, Memory >
+make_custom_alloc_handler(Memory& mem, Handler&& h)
+{
+    return custom_alloc_handler< typename ::std::decay<Handler>::type, Memory >{
+        mem, ::std::forward<Handler>(h) };
+}
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_HANDLER_ALLOCATOR_HPP_ */
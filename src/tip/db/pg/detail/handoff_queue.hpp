@@ -0,0 +1,338 @@
+/*
+ * handoff_queue.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_HANDOFF_QUEUE_HPP_
+#define TIP_DB_PG_DETAIL_HANDOFF_QUEUE_HPP_
+
+#include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/stack.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * Lock-free free-list of nodes holding values of type T. Once the pool has
+ * grown to the peak number of values in flight, storing and taking values
+ * doesn't allocate.
+ */
+template < typename T >
+class node_pool : private boost::noncopyable {
+public:
+    using value_type = T;
+    struct node {
+        typename ::std::aligned_storage< sizeof(T), alignof(T) >::type storage;
+        value_type*
+        value()
+        { return reinterpret_cast< value_type* >(&storage); }
+    };
+public:
+    explicit
+    node_pool(::std::size_t capacity_hint)
+        : free_(capacity_hint) {}
+    ~node_pool()
+    {
+        node* n;
+        while (free_.pop(n))
+            delete n;
+    }
+
+    /** Move the value into a node, taken from the free-list if possible */
+    node*
+    store(value_type&& val)
+    {
+        node* n;
+        if (!free_.pop(n))
+            n = new node;
+        new (&n->storage) value_type(::std::move(val));
+        return n;
+    }
+    /** Move the value out of the node and return the node to the free-list */
+    void
+    take(node* n, value_type& val)
+    {
+        val = ::std::move(*n->value());
+        n->value()->~value_type();
+        free_.push(n);
+    }
+    /** Destroy the value and the node */
+    static void
+    destroy(node* n)
+    {
+        n->value()->~value_type();
+        delete n;
+    }
+private:
+    ::boost::lockfree::stack< node* > free_;
+};
+
+/**
+ * Lock-free hand-off between idle resources and requests waiting for them.
+ *
+ * Idle resources are kept in a LIFO stack (most recently used first),
+ * waiting requests in a FIFO queue. A single atomic balance (number of idle
+ * resources minus number of waiting requests) decides which side an
+ * acquire or release goes to, so a request can never be left waiting
+ * while a resource sits idle.
+ *
+ * An element is always pushed before it is counted in the balance, and
+ * an operation that meets the other side in the balance takes one element
+ * from each container. Every such taker has an element that was pushed
+ * before it looked, so a pop never has to wait for a concurrent push.
+ * Resources and requests are interchangeable for the hand-off: the taker
+ * gets the most recently used resource and the oldest request, which are
+ * not necessarily the ones it has pushed.
+ *
+ * Values are kept in nodes recycled through free-lists, so once the
+ * containers have grown to their peak size acquire and release don't
+ * allocate.
+ *
+ * Waiting requests can be split into several lanes, lane 0 being the most
+ * important one. When more than one lane has requests, a released resource
+ * goes to a lane chosen by smooth weighted round-robin over lane weights,
+ * so a lane with weight 4 gets four times as many resources as a lane with
+ * weight 1 and no lane starves.
+ */
+template < typename Resource, typename Request, ::std::size_t Lanes = 1 >
+class handoff_queue : private boost::noncopyable {
+public:
+    using resource_type     = Resource;
+    using request_type      = Request;
+    using balance_type      = ::std::int64_t;
+    using weights_type      = ::std::array< unsigned, Lanes >;
+    static constexpr ::std::size_t lanes = Lanes;
+public:
+    handoff_queue()
+        : handoff_queue(equal_weights()) {}
+    explicit
+    handoff_queue(weights_type const& weights)
+        : idle_(capacity_hint), idle_nodes_(capacity_hint),
+          request_nodes_(capacity_hint), balance_(0), cursor_(0)
+    {
+        for (auto& q : waiting_)
+            q.reset(new waiting_queue(capacity_hint));
+        build_schedule(weights);
+    }
+    ~handoff_queue()
+    {
+        resource_node* res;
+        while (idle_.pop(res))
+            resource_pool::destroy(res);
+        request_node* req;
+        for (auto& q : waiting_) {
+            while (q->pop(req))
+                request_pool::destroy(req);
+        }
+    }
+
+    /**
+     * Take an idle resource or enqueue the request.
+     * @param req request, moved from if it was enqueued; if an idle resource
+     *        was taken, receives the oldest waiting request of the lane
+     * @param res receives the idle resource
+     * @param lane lane to enqueue the request to
+     * @return true if an idle resource was taken, false if the request
+     *         was enqueued.
+     */
+    bool
+    acquire(request_type& req, resource_type& res, ::std::size_t lane = 0)
+    {
+        lane = lane < Lanes ? lane : Lanes - 1;
+        waiting_[lane]->push(request_nodes_.store(::std::move(req)));
+        if (balance_.fetch_sub(1) > 0) {
+            pop_idle(res);
+            pop_waiting(req, lane);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Hand a resource to a waiting request or put it to the idle stack.
+     * @param res resource, moved from if it became idle; if a request was
+     *        taken, receives the most recently used idle resource
+     * @param req receives the waiting request
+     * @return true if a request was taken, false if the resource became idle.
+     */
+    bool
+    release(resource_type& res, request_type& req)
+    {
+        idle_.push(idle_nodes_.store(::std::move(res)));
+        if (balance_.fetch_add(1) < 0) {
+            pop_waiting(req, next_lane());
+            pop_idle(res);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Take a waiting request without providing a resource for it,
+     * e.g. to fail it.
+     * @return false if there are no waiting requests
+     */
+    bool
+    take_request(request_type& req)
+    {
+        if (!try_claim(waiting_side))
+            return false;
+        pop_waiting(req, next_lane());
+        return true;
+    }
+    /**
+     * Take an idle resource without a request, e.g. to close it.
+     * @return false if there are no idle resources
+     */
+    bool
+    take_idle(resource_type& res)
+    {
+        if (!try_claim(idle_side))
+            return false;
+        pop_idle(res);
+        return true;
+    }
+
+    /** Idle resources minus waiting requests */
+    balance_type
+    balance() const
+    { return balance_.load(::std::memory_order_relaxed); }
+    /** Number of waiting requests, approximate under contention */
+    balance_type
+    waiting() const
+    {
+        balance_type b = balance();
+        return b < 0 ? -b : 0;
+    }
+    /** Number of idle resources, approximate under contention */
+    balance_type
+    idle() const
+    {
+        balance_type b = balance();
+        return b > 0 ? b : 0;
+    }
+private:
+    enum side { idle_side, waiting_side };
+    static constexpr ::std::size_t capacity_hint = 64;
+    using resource_pool     = node_pool< resource_type >;
+    using resource_node     = typename resource_pool::node;
+    using request_pool      = node_pool< request_type >;
+    using request_node      = typename request_pool::node;
+    using waiting_queue     = ::boost::lockfree::queue< request_node* >;
+    using waiting_queue_ptr = ::std::unique_ptr< waiting_queue >;
+
+    static weights_type
+    equal_weights()
+    {
+        weights_type w;
+        w.fill(1);
+        return w;
+    }
+
+    /**
+     * Smooth weighted round-robin sequence of lanes, interleaves the lanes
+     * instead of serving them in bursts.
+     */
+    void
+    build_schedule(weights_type const& weights)
+    {
+        ::std::array< long, Lanes > current;
+        current.fill(0);
+        long total = 0;
+        for (auto w : weights)
+            total += w ? w : 1;
+        schedule_.reserve(total);
+        for (long n = 0; n < total; ++n) {
+            ::std::size_t best = 0;
+            for (::std::size_t i = 0; i < Lanes; ++i) {
+                current[i] += weights[i] ? weights[i] : 1;
+                if (current[i] > current[best])
+                    best = i;
+            }
+            current[best] -= total;
+            schedule_.push_back(best);
+        }
+    }
+
+    bool
+    try_claim(side s)
+    {
+        balance_type b = balance_.load();
+        while (s == idle_side ? b > 0 : b < 0) {
+            balance_type next = s == idle_side ? b - 1 : b + 1;
+            if (balance_.compare_exchange_weak(b, next))
+                return true;
+        }
+        return false;
+    }
+
+    /** Lane next in the schedule */
+    ::std::size_t
+    next_lane()
+    {
+        return Lanes > 1 ? schedule_[cursor_++ % schedule_.size()] : 0;
+    }
+
+    /**
+     * Pop an idle resource. The caller has claimed it in the balance, so
+     * the stack is not empty.
+     */
+    void
+    pop_idle(resource_type& res)
+    {
+        resource_node* n = nullptr;
+        idle_.pop(n);
+        idle_nodes_.take(n, res);
+    }
+
+    /**
+     * Pop a request from the preferred lane, or from the most important
+     * non-empty lane if that one is empty. The caller has claimed a request
+     * in the balance, so there is one in some lane; the scan is repeated
+     * only if a concurrent taker moved it from under the scan, which means
+     * that taker has made progress.
+     */
+    void
+    pop_waiting(request_type& req, ::std::size_t preferred)
+    {
+        request_node* n = nullptr;
+        bool found = waiting_[preferred]->pop(n);
+        while (!found) {
+            for (::std::size_t i = 0; i < Lanes && !found; ++i) {
+                found = waiting_[i]->pop(n);
+            }
+        }
+        request_nodes_.take(n, req);
+    }
+
+    ::boost::lockfree::stack< resource_node* >      idle_;
+    ::std::array< waiting_queue_ptr, Lanes >        waiting_;
+    resource_pool                                   idle_nodes_;
+    request_pool                                    request_nodes_;
+    ::std::atomic< balance_type >                   balance_;
+    ::std::vector< ::std::size_t >                  schedule_;
+    ::std::atomic< ::std::size_t >                  cursor_;
+};
+
+template < typename Resource, typename Request, ::std::size_t Lanes >
+constexpr ::std::size_t handoff_queue< Resource, Request, Lanes >::lanes;
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_HANDOFF_QUEUE_HPP_ */
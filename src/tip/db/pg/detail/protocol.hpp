@@ -82,9 +82,24 @@ enum auth_states {
      */
     GSSContinue        = 8,
     SSPI            = 9, /**< Specifies that SSPI authentication is required. */
-
+    /**
+     * Specifies that SASL authentication is required.
+     * Message contains the list of SASL mechanisms, in the server's order of preference.
+     */
+    SASL            = 10,
+    SASLContinue    = 11, /**< Message contains a SASL challenge. */
+    SASLFinal       = 12, /**< SASL authentication has completed with additional data. */
 };
 
+/**
+ * Code sent instead of the protocol version in a CancelRequest message
+ */
+const integer CANCEL_REQUEST_CODE = (1234 << 16) | 5678;
+/**
+ * Code sent instead of the protocol version in an SSLRequest message
+ */
+const integer SSL_REQUEST_CODE = (1234 << 16) | 5679;
+
 struct row_data;
 struct notice_message;
 
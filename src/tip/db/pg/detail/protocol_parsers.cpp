@@ -6,6 +6,9 @@
  */
 
 #include <tip/db/pg/detail/protocol_parsers.hpp>
+#include <tip/util/simd.hpp>
+
+#include <cstring>
 
 namespace tip {
 namespace db {
@@ -17,7 +20,7 @@ char
 bytea_parser::hex_to_byte(char input)
 {
 	if (std::isxdigit(input)) {
-		if ('0' <= input && input <= '0') {
+		if ('0' <= input && input <= '9') {
 			return input - '0';
 		} else if ('a' <= input && input <= 'f') {
 			return input - 'a' + 10;
@@ -28,6 +31,196 @@ bytea_parser::hex_to_byte(char input)
 	return 0;
 }
 
+namespace {
+
+/** Nibble value of a hex digit, or -1 for anything else */
+struct hex_table {
+	signed char values[256];
+
+	hex_table()
+	{
+		std::fill(values, values + 256, -1);
+		for (int c = '0'; c <= '9'; ++c)
+			values[c] = c - '0';
+		for (int c = 'a'; c <= 'f'; ++c)
+			values[c] = c - 'a' + 10;
+		for (int c = 'A'; c <= 'F'; ++c)
+			values[c] = c - 'A' + 10;
+	}
+};
+
+hex_table const HEX_TABLE;
+
+/**
+ * Decode n bytes from 2 * n hex digits
+ * @return false on an invalid digit
+ */
+bool
+decode_hex_scalar(char const* src, char* dst, size_t n)
+{
+	for (size_t i = 0; i < n; ++i, src += 2) {
+		signed char hi = HEX_TABLE.values[static_cast<unsigned char>(src[0])];
+		signed char lo = HEX_TABLE.values[static_cast<unsigned char>(src[1])];
+		if ((hi | lo) < 0)
+			return false;
+		*dst++ = static_cast<char>((hi << 4) | lo);
+	}
+	return true;
+}
+
+#ifdef TIP_UTIL_X86_SIMD
+/**
+ * Convert 16 hex digits to nibbles
+ * @param valid set to all ones for the lanes holding a valid digit
+ */
+__attribute__((target("ssse3")))
+inline __m128i
+hex_nibbles_ssse3(__m128i v, __m128i& valid)
+{
+	__m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+	__m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+	__m128i alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	__m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+	valid = _mm_or_si128(is_digit, is_alpha);
+	return _mm_or_si128(
+			_mm_and_si128(is_digit, digit),
+			_mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+bool
+decode_hex_ssse3(char const* src, char* dst, size_t n)
+{
+	// Multiply high nibbles by 16 and add adjacent pairs into 16-bit lanes
+	__m128i const weights = _mm_set1_epi16(0x0110);
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16, src += 32, dst += 16) {
+		__m128i valid0, valid1;
+		__m128i n0 = hex_nibbles_ssse3(
+				_mm_loadu_si128(reinterpret_cast<__m128i const*>(src)), valid0);
+		__m128i n1 = hex_nibbles_ssse3(
+				_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 16)), valid1);
+		if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xffff)
+			return false;
+		__m128i bytes = _mm_packus_epi16(
+				_mm_maddubs_epi16(n0, weights), _mm_maddubs_epi16(n1, weights));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), bytes);
+	}
+	return decode_hex_scalar(src, dst, n - i);
+}
+
+__attribute__((target("avx2")))
+inline __m256i
+hex_nibbles_avx2(__m256i v, __m256i& valid)
+{
+	__m256i digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+	__m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+	__m256i alpha = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)),
+			_mm256_set1_epi8('a'));
+	__m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+	valid = _mm256_or_si256(is_digit, is_alpha);
+	return _mm256_or_si256(
+			_mm256_and_si256(is_digit, digit),
+			_mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+bool
+decode_hex_avx2(char const* src, char* dst, size_t n)
+{
+	__m256i const weights = _mm256_set1_epi16(0x0110);
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32, src += 64, dst += 32) {
+		__m256i valid0, valid1;
+		__m256i n0 = hex_nibbles_avx2(
+				_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src)), valid0);
+		__m256i n1 = hex_nibbles_avx2(
+				_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + 32)), valid1);
+		if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1)
+			return false;
+		// packus works within 128-bit lanes, restore the order of 64-bit quarters
+		__m256i bytes = _mm256_packus_epi16(
+				_mm256_maddubs_epi16(n0, weights), _mm256_maddubs_epi16(n1, weights));
+		bytes = _mm256_permute4x64_epi64(bytes, 0xd8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), bytes);
+	}
+	return decode_hex_scalar(src, dst, n - i);
+}
+#endif /* TIP_UTIL_X86_SIMD */
+
+bool
+decode_hex(char const* src, char* dst, size_t n)
+{
+#ifdef TIP_UTIL_X86_SIMD
+	switch (::tip::util::simd::current_level()) {
+		case ::tip::util::simd::level::avx2:
+			return decode_hex_avx2(src, dst, n);
+		case ::tip::util::simd::level::ssse3:
+			return decode_hex_ssse3(src, dst, n);
+		default:
+			break;
+	}
+#endif
+	return decode_hex_scalar(src, dst, n);
+}
+
+inline bool
+is_octal(char c)
+{
+	return '0' <= c && c <= '7';
+}
+
+/**
+ * Decode escape format. Runs of literal bytes are located with memchr
+ * and copied as a whole.
+ */
+bool
+decode_escape(char const* begin, char const* end, std::vector<char>& data)
+{
+	data.resize(end - begin);
+	char* out = data.data();
+	while (begin != end) {
+		char const* bs = static_cast<char const*>(
+				std::memchr(begin, '\\', end - begin));
+		if (!bs)
+			bs = end;
+		std::memcpy(out, begin, bs - begin);
+		out += bs - begin;
+		begin = bs;
+		if (begin == end)
+			break;
+		if (end - begin >= 2 && begin[1] == '\\') {
+			*out++ = '\\';
+			begin += 2;
+		} else if (end - begin >= 4 && '0' <= begin[1] && begin[1] <= '3'
+				&& is_octal(begin[2]) && is_octal(begin[3])) {
+			*out++ = static_cast<char>(
+					((begin[1] - '0') << 6) | ((begin[2] - '0') << 3) | (begin[3] - '0'));
+			begin += 4;
+		} else {
+			return false;
+		}
+	}
+	data.resize(out - data.data());
+	return true;
+}
+
+}  // namespace
+
+bool
+decode_bytea(char const* begin, char const* end, std::vector<char>& data)
+{
+	if (end - begin >= 2 && begin[0] == '\\' && begin[1] == 'x') {
+		begin += 2;
+		if ((end - begin) % 2)
+			return false;
+		size_t n = (end - begin) / 2;
+		data.resize(n);
+		return decode_hex(begin, data.data(), n);
+	}
+	return decode_escape(begin, end, data);
+}
+
 }  // namespace detail
 }  // namespace io
 }  // namespace pg
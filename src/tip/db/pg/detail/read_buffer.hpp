@@ -0,0 +1,147 @@
+/*
+ * read_buffer.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_READ_BUFFER_HPP_
+#define TIP_DB_PG_DETAIL_READ_BUFFER_HPP_
+
+#include <tip/db/pg/asio_config.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * Receive buffer adapting its size to the reads.
+ *
+ * A read that fills the buffer doubles the size of the next one, up to the
+ * upper bound, so a large result streams in large chunks. Two reads in a
+ * row filling less than a quarter of the buffer halve it, down to the lower
+ * bound. shrink drops the size to the lower bound and releases the memory,
+ * it is called when the connection is idle.
+ *
+ * The buffer must not be changed while a read is in progress, the counters
+ * can be read by any thread.
+ */
+class read_buffer : private boost::noncopyable {
+public:
+    using counter_type  = ::std::uint64_t;
+    static constexpr ::std::size_t default_min = 8 * 1024;
+    static constexpr ::std::size_t default_max = 256 * 1024;
+public:
+    read_buffer(::std::size_t min = default_min, ::std::size_t max = default_max)
+        : min_{1}, max_{1}, size_{0}, small_reads_{0}, reads_{0}, full_reads_{0}
+    {
+        set_bounds(min, max);
+    }
+
+    /**
+     * Set the bounds of the buffer size and reset it to the lower one.
+     * The upper bound is raised to the lower one if less.
+     */
+    void
+    set_bounds(::std::size_t min, ::std::size_t max)
+    {
+        min_ = ::std::max< ::std::size_t >(min, 1);
+        max_ = ::std::max(max, min_);
+        size_ = min_;
+        small_reads_ = 0;
+        ::std::vector< char >(min_).swap(data_);
+    }
+
+    /** Buffer for the next read */
+    ASIO_NAMESPACE::mutable_buffers_1
+    prepare()
+    {
+        return ASIO_NAMESPACE::buffer(data_.data(), size_);
+    }
+
+    char const*
+    data() const
+    { return data_.data(); }
+
+    /** Account a completed read and choose the size of the next one */
+    void
+    record(::std::size_t bytes)
+    {
+        ++reads_;
+        ::std::size_t size = size_;
+        if (bytes >= size) {
+            ++full_reads_;
+            small_reads_ = 0;
+            resize(::std::min(size * 2, max_));
+        } else if (bytes < size / 4) {
+            if (++small_reads_ >= 2) {
+                small_reads_ = 0;
+                resize(::std::max(size / 2, min_));
+            }
+        } else {
+            small_reads_ = 0;
+        }
+    }
+
+    /** Drop the size to the lower bound and release the memory */
+    void
+    shrink()
+    {
+        small_reads_ = 0;
+        if (data_.size() > min_) {
+            size_ = min_;
+            ::std::vector< char >(min_).swap(data_);
+        }
+    }
+
+    /** Size of the next read */
+    ::std::size_t
+    size() const
+    { return size_; }
+    ::std::size_t
+    min() const
+    { return min_; }
+    ::std::size_t
+    max() const
+    { return max_; }
+
+    /** Number of reads */
+    counter_type
+    reads() const
+    { return reads_; }
+    /** Number of reads that filled the buffer */
+    counter_type
+    full_reads() const
+    { return full_reads_; }
+private:
+    void
+    resize(::std::size_t size)
+    {
+        if (data_.size() < size)
+            data_.resize(size);
+        size_ = size;
+    }
+
+    ::std::vector< char >               data_;
+    ::std::size_t                       min_;
+    ::std::size_t                       max_;
+    ::std::atomic< ::std::size_t >      size_;
+    int                                 small_reads_;
+    ::std::atomic< counter_type >       reads_;
+    ::std::atomic< counter_type >       full_reads_;
+};
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_READ_BUFFER_HPP_ */
@@ -0,0 +1,108 @@
+/*
+ * resolver_cache.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_RESOLVER_CACHE_HPP_
+#define TIP_DB_PG_DETAIL_RESOLVER_CACHE_HPP_
+
+#include <tip/db/pg/asio_config.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * Resolved addresses of the hosts, shared by the connections of a pool.
+ *
+ * The system resolver doesn't tell the record TTL, so an entry is kept for
+ * a fixed time. An entry is dropped when connections to all of its
+ * addresses fail, so a moved server is resolved again.
+ */
+class resolver_cache : private boost::noncopyable {
+public:
+    using clock_type        = ::std::chrono::steady_clock;
+    using duration          = clock_type::duration;
+    using endpoint_type     = asio_config::tcp::endpoint;
+    using endpoints_type    = ::std::vector< endpoint_type >;
+public:
+    explicit
+    resolver_cache(duration ttl) : ttl_{ttl} {}
+
+    /**
+     * Get the addresses of a host
+     * @return false if the host is not in the cache or the entry expired
+     */
+    bool
+    find(::std::string const& host, ::std::string const& port,
+            endpoints_type& endpoints)
+    {
+        lock_type lock{mutex_};
+        auto f = entries_.find(key(host, port));
+        if (f == entries_.end())
+            return false;
+        if (f->second.expires <= clock_type::now()) {
+            entries_.erase(f);
+            return false;
+        }
+        endpoints = f->second.endpoints;
+        return true;
+    }
+
+    void
+    store(::std::string const& host, ::std::string const& port,
+            endpoints_type const& endpoints)
+    {
+        if (endpoints.empty())
+            return;
+        lock_type lock{mutex_};
+        entry& e = entries_[key(host, port)];
+        e.endpoints = endpoints;
+        e.expires = clock_type::now() + ttl_;
+    }
+
+    void
+    invalidate(::std::string const& host, ::std::string const& port)
+    {
+        lock_type lock{mutex_};
+        entries_.erase(key(host, port));
+    }
+
+    duration
+    ttl() const
+    { return ttl_; }
+private:
+    using mutex_type    = ::std::mutex;
+    using lock_type     = ::std::lock_guard< mutex_type >;
+    struct entry {
+        endpoints_type          endpoints;
+        clock_type::time_point  expires;
+    };
+    using entries_type  = ::std::map< ::std::string, entry >;
+
+    static ::std::string
+    key(::std::string const& host, ::std::string const& port)
+    { return host + ":" + port; }
+
+    duration        ttl_;
+    mutex_type      mutex_;
+    entries_type    entries_;
+};
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_RESOLVER_CACHE_HPP_ */
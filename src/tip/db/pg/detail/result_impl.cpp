@@ -6,6 +6,8 @@
  */
 
 #include <tip/db/pg/detail/result_impl.hpp>
+#include <tip/db/pg/error.hpp>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -67,6 +69,73 @@ result_impl::buffer_bounds(uinteger row, usmallint col) const
 	return rd.field_buffer_bounds(col);
 }
 
+void
+result_impl::build_name_index() const
+{
+	name_index_.reserve(row_description_.size());
+	for (usmallint i = 0; i < row_description_.size(); ++i) {
+		// The first column with the name wins, as with linear search
+		name_index_.insert(std::make_pair(row_description_[i].name, i));
+	}
+}
+
+usmallint
+result_impl::index_of_name(std::string const& name) const
+{
+	std::call_once(name_index_built_, &result_impl::build_name_index, this);
+	auto f = name_index_.find(name);
+	if (f != name_index_.end())
+		return f->second;
+	return npos;
+}
+
+template < typename Names >
+result_impl::column_indexes_ptr
+result_impl::bind_names(Names const& names) const
+{
+	std::hash<std::string> hash_name;
+	std::size_t hash = names.size();
+	for (std::string const& name : names) {
+		hash ^= hash_name(name) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+	std::lock_guard<std::mutex> lock(bindings_mutex_);
+	auto range = bindings_.equal_range(hash);
+	for (auto b = range.first; b != range.second; ++b) {
+		name_list const& cached = b->second.first;
+		if (cached.size() == names.size() &&
+				std::equal(names.begin(), names.end(), cached.begin())) {
+			return b->second.second;
+		}
+	}
+	auto indexes = std::make_shared< column_indexes >();
+	indexes->reserve(names.size());
+	for (std::string const& name : names) {
+		usmallint idx = index_of_name(name);
+		if (idx == npos)
+			throw error::db_error{"No field with name " + name};
+		indexes->push_back(idx);
+	}
+	// Names built at run time can make every bind a miss, keep the cache
+	// bounded. Bindings handed out earlier share their indexes.
+	if (bindings_.size() >= max_cached_bindings)
+		bindings_.clear();
+	bindings_.emplace(hash,
+			binding_type{ name_list(names.begin(), names.end()), indexes });
+	return indexes;
+}
+
+result_impl::column_indexes_ptr
+result_impl::bind(std::initializer_list<std::string> const& names) const
+{
+	return bind_names(names);
+}
+
+result_impl::column_indexes_ptr
+result_impl::bind(std::vector<std::string> const& names) const
+{
+	return bind_names(names);
+}
+
 } /* namespace detail */
 } /* namespace pg */
 } /* namespace db */
@@ -10,6 +10,11 @@
 
 #include <tip/db/pg/common.hpp>
 #include <tip/db/pg/detail/protocol.hpp>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace tip {
@@ -20,6 +25,11 @@ namespace detail {
 class result_impl {
 public:
 	typedef std::vector<row_data> row_set_type;
+	typedef std::vector<usmallint> column_indexes;
+	typedef std::shared_ptr< column_indexes const > column_indexes_ptr;
+	/** Maximum number of name lists kept in the binding cache */
+	static constexpr std::size_t max_cached_bindings = 16;
+	static constexpr usmallint npos = static_cast<usmallint>(-1);
 public:
 	result_impl();
 
@@ -48,11 +58,48 @@ public:
 
 	bool
 	is_null(uinteger row, usmallint col) const;
+
+	/**
+	 * Index of column with the name, looked up in a hash index that is
+	 * built on first use.
+	 * @return column index or npos if not found
+	 */
+	usmallint
+	index_of_name(std::string const& name) const;
+
+	/**
+	 * Resolve a list of column names to column indexes. The result is
+	 * cached by the hash of the names. The cache holds at most
+	 * max_cached_bindings name lists and is dropped when it is full, the
+	 * indexes handed out before stay owned by their bindings.
+	 * @throw db_error if a name is not found
+	 */
+	column_indexes_ptr
+	bind(std::initializer_list<std::string> const& names) const;
+	column_indexes_ptr
+	bind(std::vector<std::string> const& names) const;
 private:
 	void
 	check_row_index(uinteger row) const;
+	void
+	build_name_index() const;
+
+	template < typename Names >
+	column_indexes_ptr
+	bind_names(Names const& names) const;
+
+	typedef std::unordered_map< std::string, usmallint > name_index_type;
+	typedef std::vector< std::string > name_list;
+	typedef std::pair< name_list, column_indexes_ptr > binding_type;
+	typedef std::unordered_multimap< std::size_t, binding_type > binding_cache_type;
+
 	row_description_type row_description_;
 	row_set_type rows_;
+
+	mutable std::once_flag name_index_built_;
+	mutable name_index_type name_index_;
+	mutable std::mutex bindings_mutex_;
+	mutable binding_cache_type bindings_;
 };
 
 } /* namespace detail */
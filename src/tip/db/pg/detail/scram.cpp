@@ -0,0 +1,231 @@
+/*
+ * scram.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <tip/db/pg/detail/scram.hpp>
+#include <tip/db/pg/error.hpp>
+
+#include <random>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+namespace {
+
+/** Random bytes of the client nonce */
+const ::std::size_t NONCE_SIZE = 18;
+/** No channel binding, no authorization identity */
+const ::std::string GS2_HEADER = "n,,";
+/** The gs2 header, base64 encoded */
+const ::std::string CHANNEL_BINDING = "biws";
+
+const char base64_chars[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+}  // namespace
+
+::std::string
+base64_encode(::std::string const& in)
+{
+    ::std::string out;
+    out.reserve((in.size() + 2) / 3 * 4);
+    ::std::size_t i = 0;
+    for (; i + 2 < in.size(); i += 3) {
+        unsigned v = (::std::uint8_t(in[i]) << 16) |
+                (::std::uint8_t(in[i + 1]) << 8) | ::std::uint8_t(in[i + 2]);
+        out.push_back(base64_chars[(v >> 18) & 0x3f]);
+        out.push_back(base64_chars[(v >> 12) & 0x3f]);
+        out.push_back(base64_chars[(v >> 6) & 0x3f]);
+        out.push_back(base64_chars[v & 0x3f]);
+    }
+    if (i < in.size()) {
+        unsigned v = ::std::uint8_t(in[i]) << 16;
+        if (i + 1 < in.size())
+            v |= ::std::uint8_t(in[i + 1]) << 8;
+        out.push_back(base64_chars[(v >> 18) & 0x3f]);
+        out.push_back(base64_chars[(v >> 12) & 0x3f]);
+        out.push_back(i + 1 < in.size() ? base64_chars[(v >> 6) & 0x3f] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+bool
+base64_decode(::std::string const& in, ::std::string& out)
+{
+    if (in.size() % 4)
+        return false;
+    out.clear();
+    unsigned v = 0;
+    int bits = 0;
+    ::std::size_t padding = 0;
+    for (char c : in) {
+        int d;
+        if (c >= 'A' && c <= 'Z') {
+            d = c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            d = c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            d = c - '0' + 52;
+        } else if (c == '+') {
+            d = 62;
+        } else if (c == '/') {
+            d = 63;
+        } else if (c == '=') {
+            ++padding;
+            continue;
+        } else {
+            return false;
+        }
+        if (padding)
+            return false;
+        v = (v << 6) | d;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast< char >((v >> bits) & 0xff));
+        }
+    }
+    return padding <= 2;
+}
+
+namespace {
+
+/** Escape a user name as a saslname */
+::std::string
+sasl_name(::std::string const& name)
+{
+    ::std::string out;
+    for (char c : name) {
+        if (c == '=') {
+            out += "=3D";
+        } else if (c == ',') {
+            out += "=2C";
+        } else {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+::std::string
+random_nonce()
+{
+    ::std::random_device rd;
+    ::std::string bytes;
+    while (bytes.size() < NONCE_SIZE) {
+        auto v = rd();
+        for (::std::size_t i = 0; i < sizeof(v) && bytes.size() < NONCE_SIZE; ++i) {
+            bytes.push_back(static_cast< char >(v >> (i * 8)));
+        }
+    }
+    return base64_encode(bytes);
+}
+
+/** Value of attribute name in a comma-separated list of name=value pairs */
+bool
+attribute(::std::string const& msg, char name, ::std::string& value)
+{
+    ::std::string::size_type pos = 0;
+    while (pos < msg.size()) {
+        ::std::string::size_type end = msg.find(',', pos);
+        if (end == ::std::string::npos)
+            end = msg.size();
+        if (end - pos >= 2 && msg[pos] == name && msg[pos + 1] == '=') {
+            value = msg.substr(pos + 2, end - pos - 2);
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+void
+protocol_error(::std::string const& what)
+{
+    throw error::connection_error("SCRAM authentication failed: " + what);
+}
+
+}  // namespace
+
+const ::std::string scram_client::mechanism = "SCRAM-SHA-256";
+
+scram_client::scram_client(::std::string const& password, key_cache_ptr cache,
+        ::std::string const& user, ::std::string const& nonce)
+    : password_(password), cache_(cache),
+      nonce_(nonce.empty() ? random_nonce() : nonce),
+      first_bare_("n=" + sasl_name(user) + ",r=" + nonce_),
+      keys_(), cached_keys_(false)
+{
+}
+
+::std::string
+scram_client::first_message() const
+{
+    return GS2_HEADER + first_bare_;
+}
+
+::std::string
+scram_client::final_message(::std::string const& server_first)
+{
+    ::std::string nonce, salt64, iterations_str, salt;
+    if (!attribute(server_first, 'r', nonce) ||
+            !attribute(server_first, 's', salt64) ||
+            !attribute(server_first, 'i', iterations_str)) {
+        protocol_error("malformed server-first-message");
+    }
+    if (nonce.size() <= nonce_.size() || nonce.compare(0, nonce_.size(), nonce_) != 0)
+        protocol_error("server nonce doesn't start with the client nonce");
+    if (!base64_decode(salt64, salt))
+        protocol_error("malformed salt");
+    unsigned iterations = 0;
+    try {
+        unsigned long v = ::std::stoul(iterations_str);
+        iterations = static_cast< unsigned >(v);
+    } catch (::std::exception const&) {
+    }
+    if (iterations == 0)
+        protocol_error("invalid iteration count");
+
+    if (cache_ && cache_->find(salt, iterations, keys_)) {
+        cached_keys_ = true;
+    } else {
+        ::std::string salted = to_string(pbkdf2_sha256(password_, salt, iterations));
+        keys_.client_key = hmac_sha256(salted, "Client Key");
+        keys_.server_key = hmac_sha256(salted, "Server Key");
+        if (cache_)
+            cache_->store(salt, iterations, keys_);
+    }
+
+    ::std::string final_bare = "c=" + CHANNEL_BINDING + ",r=" + nonce;
+    auth_message_ = first_bare_ + "," + server_first + "," + final_bare;
+    sha256::digest_type stored_key = sha256::digest(to_string(keys_.client_key));
+    sha256::digest_type proof = hmac_sha256(to_string(stored_key), auth_message_);
+    for (::std::size_t i = 0; i < proof.size(); ++i)
+        proof[i] ^= keys_.client_key[i];
+    return final_bare + ",p=" + base64_encode(to_string(proof));
+}
+
+void
+scram_client::verify(::std::string const& server_final) const
+{
+    ::std::string value;
+    if (attribute(server_final, 'e', value))
+        protocol_error(value);
+    if (auth_message_.empty() || !attribute(server_final, 'v', value))
+        protocol_error("malformed server-final-message");
+    ::std::string signature = to_string(
+            hmac_sha256(to_string(keys_.server_key), auth_message_));
+    if (value != base64_encode(signature))
+        protocol_error("server signature mismatch");
+}
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
@@ -0,0 +1,136 @@
+/*
+ * scram.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_SCRAM_HPP_
+#define TIP_DB_PG_DETAIL_SCRAM_HPP_
+
+#include <tip/db/pg/detail/sha256.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/** Base64 with padding */
+::std::string
+base64_encode(::std::string const& in);
+/** @return false if the input is not valid base64 */
+bool
+base64_decode(::std::string const& in, ::std::string& out);
+
+/** Keys derived from the password by the salted password iterations */
+struct scram_keys {
+    sha256::digest_type client_key;
+    sha256::digest_type server_key;
+};
+
+/**
+ * Derived keys shared by the connections of a pool, so that only the first
+ * connection pays for the password iterations. The keys are looked up by
+ * the salt and the iteration count, the cache must be used with a single
+ * password.
+ */
+class scram_key_cache : private boost::noncopyable {
+public:
+    bool
+    find(::std::string const& salt, unsigned iterations, scram_keys& keys) const
+    {
+        lock_type lock{mutex_};
+        auto f = keys_.find(key(salt, iterations));
+        if (f == keys_.end())
+            return false;
+        keys = f->second;
+        return true;
+    }
+
+    void
+    store(::std::string const& salt, unsigned iterations, scram_keys const& keys)
+    {
+        lock_type lock{mutex_};
+        keys_[key(salt, iterations)] = keys;
+    }
+
+    ::std::size_t
+    size() const
+    {
+        lock_type lock{mutex_};
+        return keys_.size();
+    }
+private:
+    using mutex_type    = ::std::mutex;
+    using lock_type     = ::std::lock_guard< mutex_type >;
+    using keys_type     = ::std::map< ::std::string, scram_keys >;
+
+    static ::std::string
+    key(::std::string const& salt, unsigned iterations)
+    { return ::std::to_string(iterations) + ":" + salt; }
+
+    mutable mutex_type  mutex_;
+    keys_type           keys_;
+};
+
+/**
+ * Client side of SCRAM-SHA-256 authentication (RFC 5802, RFC 7677),
+ * without channel binding.
+ *
+ * The password is used as is, without SASLprep normalization. The methods
+ * throw error::connection_error on a malformed or unexpected server message.
+ */
+class scram_client {
+public:
+    using key_cache_ptr = ::std::shared_ptr< scram_key_cache >;
+    /** The SASL mechanism name */
+    static const ::std::string mechanism;
+public:
+    /**
+     * @param password
+     * @param cache Derived keys cache, can be empty
+     * @param user User name to send, the server takes the name from the
+     *          startup message and ignores this one
+     * @param nonce Client nonce, generated if empty
+     */
+    scram_client(::std::string const& password, key_cache_ptr cache,
+            ::std::string const& user = ::std::string{},
+            ::std::string const& nonce = ::std::string{});
+
+    /** client-first-message */
+    ::std::string
+    first_message() const;
+    /** Process server-first-message, make client-final-message */
+    ::std::string
+    final_message(::std::string const& server_first);
+    /** Check the server signature in server-final-message */
+    void
+    verify(::std::string const& server_final) const;
+
+    /** The keys were taken from the cache */
+    bool
+    cached_keys() const
+    { return cached_keys_; }
+private:
+    ::std::string       password_;
+    key_cache_ptr       cache_;
+    ::std::string       nonce_;
+    ::std::string       first_bare_;
+    ::std::string       auth_message_;
+    scram_keys          keys_;
+    bool                cached_keys_;
+};
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_SCRAM_HPP_ */
@@ -0,0 +1,207 @@
+/*
+ * service_runner.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <tip/db/pg/detail/service_runner.hpp>
+#include <tip/db/pg/detail/atomic_histogram.hpp>
+
+#include <tip/db/pg/log.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+LOCAL_LOGGING_FACILITY_CFG(PGRUN, config::SERVICE_LOG);
+
+struct service_runner::probe {
+    using clock_type    = ::std::chrono::steady_clock;
+
+    asio_config::io_service::strand strand;
+    asio_config::steady_timer       timer;
+    clock_type::duration            interval;
+    clock_type::time_point          expected;
+    atomic_histogram                lag;
+    bool                            stopped;
+
+    probe(asio_config::io_service& svc, runner_options::duration i)
+        : strand{svc}, timer{svc}, interval{i}, stopped{false} {}
+};
+
+service_runner::service_runner(services_list const& services,
+        runner_options const& opts, run_function run)
+    : services_{services}, options_{opts}, run_{run}, draining_{false}
+{
+}
+
+service_runner::~service_runner()
+{
+    for (auto const& svc : services_) {
+        svc->stop();
+    }
+    for (auto& t : threads_) {
+        if (!t.joinable())
+            continue;
+        if (t.get_id() == ::std::this_thread::get_id()) {
+            t.detach();
+        } else {
+            t.join();
+        }
+    }
+}
+
+void
+service_runner::start(::std::shared_ptr<void> const& owner)
+{
+    ::std::size_t count = services_.size() > 1 ? services_.size() :
+            options_.threads ? options_.threads :
+            ::std::max(::std::thread::hardware_concurrency(), 1u);
+    local_log(logger::INFO) << "Start " << count << " thread(s) for "
+            << services_.size() << " service(s)";
+
+    for (auto const& svc : services_) {
+        work_.emplace_back(new asio_config::io_service::work(*svc));
+        if (options_.lag_probe_interval > runner_options::duration::zero()) {
+            probe_ptr p = ::std::make_shared< probe >(*svc,
+                    options_.lag_probe_interval);
+            probes_.push_back(p);
+            p->strand.post([p](){ schedule_probe(p); });
+        }
+    }
+
+    threads_.reserve(count);
+    for (::std::size_t n = 0; n < count; ++n) {
+        ::std::size_t svc = services_.size() > 1 ? n : 0;
+        threads_.emplace_back(
+        [this, owner, n, svc]()
+        {
+            if (options_.pin_threads)
+                pin_thread(n);
+            // Keep running the service if a handler throws
+            for (;;) {
+                try {
+                    run_(svc);
+                    break;
+                } catch (::std::exception const& e) {
+                    local_log(logger::ERROR) << "Exception in service thread "
+                            << n << ": " << e.what();
+                } catch (...) {
+                    local_log(logger::ERROR) << "Unknown exception in service thread "
+                            << n;
+                }
+            }
+        });
+    }
+}
+
+void
+service_runner::drain()
+{
+    if (draining_.exchange(true))
+        return;
+    local_log(logger::INFO) << "Drain service threads";
+    for (auto const& p : probes_) {
+        p->strand.post(
+        [p]()
+        {
+            p->stopped = true;
+            p->timer.cancel();
+        });
+    }
+    work_.clear();
+
+    for (auto const& svc : services_) {
+        auto timer = ::std::make_shared< asio_config::steady_timer >(*svc);
+        timer->expires_from_now(options_.drain_timeout);
+        timer->async_wait(
+        [svc, timer](asio_config::error_code const& ec)
+        {
+            if (!ec) {
+                local_log(logger::WARNING) << "Drain timeout expired, stop the service";
+                svc->stop();
+            }
+        });
+    }
+}
+
+void
+service_runner::join()
+{
+    for (auto& t : threads_) {
+        if (t.joinable() && t.get_id() != ::std::this_thread::get_id())
+            t.join();
+    }
+}
+
+bool
+service_runner::runner_thread() const
+{
+    auto id = ::std::this_thread::get_id();
+    return ::std::any_of(threads_.begin(), threads_.end(),
+            [id](::std::thread const& t){ return t.get_id() == id; });
+}
+
+service_runner::lag_list
+service_runner::lag() const
+{
+    lag_list res;
+    res.reserve(probes_.size());
+    for (auto const& p : probes_) {
+        res.push_back(p->lag.snapshot());
+    }
+    return res;
+}
+
+void
+service_runner::schedule_probe(probe_ptr p)
+{
+    p->expected = probe::clock_type::now() + p->interval;
+    p->timer.expires_at(p->expected);
+    p->timer.async_wait(p->strand.wrap(
+    [p](asio_config::error_code const& ec)
+    {
+        if (ec || p->stopped)
+            return;
+        auto late = probe::clock_type::now() - p->expected;
+        if (late < probe::clock_type::duration::zero())
+            late = probe::clock_type::duration::zero();
+        p->lag.record(::std::chrono::duration_cast< atomic_histogram::duration >(late));
+        schedule_probe(p);
+    }));
+}
+
+void
+service_runner::pin_thread(::std::size_t n)
+{
+#if defined(__linux__)
+    unsigned cpus = ::std::max(::std::thread::hardware_concurrency(), 1u);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(n % cpus, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc) {
+        local_log(logger::WARNING) << "Failed to pin service thread " << n
+                << " to CPU " << n % cpus << ": error " << rc;
+    }
+#else
+    local_log(logger::WARNING) << "Pinning threads to CPUs is not supported "
+            "on the platform";
+#endif
+}
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
@@ -0,0 +1,96 @@
+/*
+ * service_runner.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_SERVICE_RUNNER_HPP_
+#define TIP_DB_PG_DETAIL_SERVICE_RUNNER_HPP_
+
+#include <tip/db/pg/asio_config.hpp>
+#include <tip/db/pg/database.hpp>
+#include <tip/db/pg/metrics.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+struct atomic_histogram;
+
+/**
+ * Threads running the io_services of the database service.
+ *
+ * A single service is run by the configured number of threads, several
+ * services (shards) are run by a thread each. Every service gets a lag
+ * probe, a timer measuring how late its handlers are run.
+ */
+class service_runner : private boost::noncopyable {
+public:
+    using io_service_ptr    = asio_config::io_service_ptr;
+    using services_list     = ::std::vector< io_service_ptr >;
+    /** Runs the service with the number on the calling thread */
+    using run_function      = ::std::function< void (::std::size_t) >;
+    using lag_list          = ::std::vector< latency_histogram >;
+public:
+    service_runner(services_list const&, runner_options const&, run_function);
+    ~service_runner();
+
+    /**
+     * Start the threads
+     * @param owner object the threads keep alive while running
+     */
+    void
+    start(::std::shared_ptr<void> const& owner);
+    /**
+     * Stop the lag probes and let the services run out of work, stop the
+     * services that didn't after the drain timeout.
+     */
+    void
+    drain();
+    /** Wait for the threads, except the calling one */
+    void
+    join();
+    /** The calling thread is one of the runner threads */
+    bool
+    runner_thread() const;
+
+    /** Lag of the services */
+    lag_list
+    lag() const;
+private:
+    struct probe;
+    using probe_ptr         = ::std::shared_ptr< probe >;
+    using probes_list       = ::std::vector< probe_ptr >;
+    using work_ptr          = ::std::unique_ptr< asio_config::io_service::work >;
+    using threads_list      = ::std::vector< ::std::thread >;
+
+    static void
+    schedule_probe(probe_ptr);
+    void
+    pin_thread(::std::size_t n);
+
+    services_list           services_;
+    runner_options          options_;
+    run_function            run_;
+    probes_list             probes_;
+    ::std::vector< work_ptr > work_;
+    threads_list            threads_;
+    ::std::atomic<bool>     draining_;
+};
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_SERVICE_RUNNER_HPP_ */
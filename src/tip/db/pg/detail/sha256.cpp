@@ -0,0 +1,218 @@
+/*
+ * sha256.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <tip/db/pg/detail/sha256.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+namespace {
+
+const ::std::uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline ::std::uint32_t
+rotr(::std::uint32_t x, unsigned n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+/** HMAC key padded to the block size, xored with the pad byte */
+::std::array< ::std::uint8_t, sha256::block_size >
+hmac_pad(::std::string const& key, ::std::uint8_t pad)
+{
+    ::std::array< ::std::uint8_t, sha256::block_size > block;
+    block.fill(pad);
+    if (key.size() > sha256::block_size) {
+        sha256::digest_type d = sha256::digest(key);
+        for (::std::size_t i = 0; i < d.size(); ++i)
+            block[i] ^= d[i];
+    } else {
+        for (::std::size_t i = 0; i < key.size(); ++i)
+            block[i] ^= static_cast< ::std::uint8_t >(key[i]);
+    }
+    return block;
+}
+
+/**
+ * HMAC with the inner and outer pads hashed once, for computing many
+ * HMACs with the same key
+ */
+class hmac_context {
+public:
+    hmac_context(::std::string const& key)
+    {
+        auto ipad = hmac_pad(key, 0x36);
+        auto opad = hmac_pad(key, 0x5c);
+        inner_.update(ipad.data(), ipad.size());
+        outer_.update(opad.data(), opad.size());
+    }
+
+    sha256::digest_type
+    operator()(void const* data, ::std::size_t size) const
+    {
+        sha256 inner = inner_;
+        inner.update(data, size);
+        sha256::digest_type d = inner.finish();
+        sha256 outer = outer_;
+        outer.update(d.data(), d.size());
+        return outer.finish();
+    }
+private:
+    sha256 inner_;
+    sha256 outer_;
+};
+
+}  // namespace
+
+constexpr ::std::size_t sha256::digest_size;
+constexpr ::std::size_t sha256::block_size;
+
+sha256::sha256()
+    : state_{{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+               0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 }},
+      length_{0}, buffered_{0}
+{
+}
+
+void
+sha256::update(void const* data, ::std::size_t size)
+{
+    auto p = static_cast< ::std::uint8_t const* >(data);
+    length_ += size;
+    if (buffered_ > 0) {
+        ::std::size_t n = ::std::min(size, block_size - buffered_);
+        ::std::memcpy(buffer_.data() + buffered_, p, n);
+        buffered_ += n;
+        p += n;
+        size -= n;
+        if (buffered_ < block_size)
+            return;
+        transform(buffer_.data());
+        buffered_ = 0;
+    }
+    for (; size >= block_size; p += block_size, size -= block_size) {
+        transform(p);
+    }
+    ::std::memcpy(buffer_.data(), p, size);
+    buffered_ = size;
+}
+
+sha256::digest_type
+sha256::finish()
+{
+    ::std::uint64_t bits = length_ * 8;
+    static const ::std::uint8_t padding[block_size] = { 0x80 };
+    ::std::size_t pad = (buffered_ < 56) ? 56 - buffered_ : 120 - buffered_;
+    update(padding, pad);
+    ::std::uint8_t len[8];
+    for (int i = 0; i < 8; ++i)
+        len[i] = static_cast< ::std::uint8_t >(bits >> (56 - i * 8));
+    update(len, sizeof(len));
+
+    digest_type d;
+    for (::std::size_t i = 0; i < state_.size(); ++i) {
+        d[i * 4]     = static_cast< ::std::uint8_t >(state_[i] >> 24);
+        d[i * 4 + 1] = static_cast< ::std::uint8_t >(state_[i] >> 16);
+        d[i * 4 + 2] = static_cast< ::std::uint8_t >(state_[i] >> 8);
+        d[i * 4 + 3] = static_cast< ::std::uint8_t >(state_[i]);
+    }
+    return d;
+}
+
+sha256::digest_type
+sha256::digest(::std::string const& data)
+{
+    sha256 h;
+    h.update(data);
+    return h.finish();
+}
+
+void
+sha256::transform(::std::uint8_t const* block)
+{
+    ::std::uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (::std::uint32_t(block[i * 4]) << 24) |
+                (::std::uint32_t(block[i * 4 + 1]) << 16) |
+                (::std::uint32_t(block[i * 4 + 2]) << 8) |
+                ::std::uint32_t(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        ::std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        ::std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    ::std::uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3],
+            e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (int i = 0; i < 64; ++i) {
+        ::std::uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        ::std::uint32_t ch = (e & f) ^ (~e & g);
+        ::std::uint32_t t1 = h + s1 + ch + round_constants[i] + w[i];
+        ::std::uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        ::std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        ::std::uint32_t t2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+}
+
+sha256::digest_type
+hmac_sha256(::std::string const& key, ::std::string const& data)
+{
+    return hmac_context{key}(data.data(), data.size());
+}
+
+sha256::digest_type
+pbkdf2_sha256(::std::string const& password, ::std::string const& salt,
+        unsigned iterations)
+{
+    hmac_context prf{password};
+    // U1 = PRF(password, salt || INT(1))
+    ::std::string first = salt;
+    first.append("\0\0\0\1", 4);
+    sha256::digest_type u = prf(first.data(), first.size());
+    sha256::digest_type result = u;
+    for (unsigned i = 1; i < iterations; ++i) {
+        u = prf(u.data(), u.size());
+        for (::std::size_t j = 0; j < result.size(); ++j)
+            result[j] ^= u[j];
+    }
+    return result;
+}
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
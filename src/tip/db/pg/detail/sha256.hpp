@@ -0,0 +1,74 @@
+/*
+ * sha256.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_SHA256_HPP_
+#define TIP_DB_PG_DETAIL_SHA256_HPP_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * SHA-256 message digest (FIPS 180-4)
+ */
+class sha256 {
+public:
+    static constexpr ::std::size_t digest_size  = 32;
+    static constexpr ::std::size_t block_size   = 64;
+    using digest_type = ::std::array< ::std::uint8_t, digest_size >;
+public:
+    sha256();
+
+    void
+    update(void const* data, ::std::size_t size);
+    void
+    update(::std::string const& data)
+    { update(data.data(), data.size()); }
+
+    /** Finish the digest, the object must not be updated after that */
+    digest_type
+    finish();
+
+    static digest_type
+    digest(::std::string const& data);
+private:
+    void
+    transform(::std::uint8_t const* block);
+
+    ::std::array< ::std::uint32_t, 8 >  state_;
+    ::std::array< ::std::uint8_t, block_size > buffer_;
+    ::std::uint64_t                     length_;
+    ::std::size_t                       buffered_;
+};
+
+/** HMAC-SHA-256 (RFC 2104) */
+sha256::digest_type
+hmac_sha256(::std::string const& key, ::std::string const& data);
+
+/** PBKDF2 with HMAC-SHA-256 (RFC 8018), a key of a single block */
+sha256::digest_type
+pbkdf2_sha256(::std::string const& password, ::std::string const& salt,
+        unsigned iterations);
+
+/** The digest as a byte string */
+inline ::std::string
+to_string(sha256::digest_type const& d)
+{
+    return ::std::string(d.begin(), d.end());
+}
+
+} /* namespace detail */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* TIP_DB_PG_DETAIL_SHA256_HPP_ */
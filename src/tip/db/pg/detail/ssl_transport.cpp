@@ -0,0 +1,283 @@
+/*
+ * ssl_transport.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <tip/db/pg/detail/ssl_transport.hpp>
+#include <tip/db/pg/detail/protocol.hpp>
+#include <tip/db/pg/error.hpp>
+
+#include <tip/db/pg/log.hpp>
+
+#include <openssl/x509v3.h>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+LOCAL_LOGGING_FACILITY_CFG(PGSSL, config::CONNECTION_LOG);
+
+namespace {
+
+bool
+is_ip_address(std::string const& host)
+{
+	asio_config::error_code ec;
+	ASIO_NAMESPACE::ip::address::from_string(host, ec);
+	return !ec;
+}
+
+// The app data of the context and the connection is taken by asio for the
+// verify callback
+int
+cache_index()
+{
+	static int const index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+	return index;
+}
+
+void
+free_session_key(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*)
+{
+	delete static_cast< std::string* >(ptr);
+}
+
+/** The connection owns the key of its session, freed with the connection */
+int
+session_key_index()
+{
+	static int const index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr,
+			&free_session_key);
+	return index;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------
+// tls_session_cache implementation
+//----------------------------------------------------------------------------
+tls_session_cache::tls_session_cache(connection_options const& opts)
+	: context_(context_type::tls_client), verify_(false)
+{
+	context_.set_options(context_type::default_workarounds |
+			context_type::no_sslv2 | context_type::no_sslv3);
+	if (!opts.ssl_root_cert.empty()) {
+		asio_config::error_code ec;
+		context_.load_verify_file(opts.ssl_root_cert, ec);
+		if (ec) {
+			throw error::connection_error("Failed to load root certificate "
+					+ opts.ssl_root_cert + ": " + ec.message());
+		}
+		context_.set_verify_mode(ASIO_NAMESPACE::ssl::verify_peer);
+		verify_ = true;
+	} else {
+		context_.set_verify_mode(ASIO_NAMESPACE::ssl::verify_none);
+	}
+	SSL_CTX* ctx = context_.native_handle();
+	SSL_CTX_set_ex_data(ctx, cache_index(), this);
+	// The sessions are kept here, per host
+	SSL_CTX_set_session_cache_mode(ctx,
+			SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(ctx, &tls_session_cache::new_session);
+}
+
+tls_session_cache::~tls_session_cache()
+{
+	for (auto& s : sessions_)
+		SSL_SESSION_free(s.second);
+}
+
+bool
+tls_session_cache::resume(SSL* ssl, std::string const& host)
+{
+	delete static_cast< std::string* >(SSL_get_ex_data(ssl, session_key_index()));
+	SSL_set_ex_data(ssl, session_key_index(), new std::string(host));
+	lock_type lock(mutex_);
+	auto f = sessions_.find(host);
+	if (f == sessions_.end() || !SSL_SESSION_is_resumable(f->second))
+		return false;
+	return SSL_set_session(ssl, f->second) == 1;
+}
+
+std::size_t
+tls_session_cache::size() const
+{
+	lock_type lock(mutex_);
+	return sessions_.size();
+}
+
+int
+tls_session_cache::new_session(SSL* ssl, SSL_SESSION* session)
+{
+	auto cache = static_cast< tls_session_cache* >(
+			SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), cache_index()));
+	auto host = static_cast< std::string const* >(
+			SSL_get_ex_data(ssl, session_key_index()));
+	if (!cache || !host)
+		return 0;
+	cache->store(*host, session);
+	// Keep the reference
+	return 1;
+}
+
+void
+tls_session_cache::store(std::string const& host, SSL_SESSION* session)
+{
+	lock_type lock(mutex_);
+	SSL_SESSION*& s = sessions_[host];
+	if (s)
+		SSL_SESSION_free(s);
+	s = session;
+}
+
+//----------------------------------------------------------------------------
+// ssl_transport implementation
+//----------------------------------------------------------------------------
+ssl_transport::ssl_transport(io_service_ptr service)
+	: service_(service), tcp_(service), strand_(*service),
+	  response_(0), session_reused_(false)
+{
+}
+
+ssl_transport::~ssl_transport()
+{
+	close();
+}
+
+void
+ssl_transport::connect_async(connection_options const& conn, connect_callback cb,
+		connection_caches const& caches)
+{
+	if (conn.schema != "ssl") {
+		throw error::connection_error("Wrong connection schema for SSL transport");
+	}
+	close();
+	session_reused_ = false;
+	cache_ = caches.tls ? caches.tls : std::make_shared< tls_session_cache >(conn);
+
+	connection_options tcp_opts = conn;
+	tcp_opts.schema = "tcp";
+	tcp_.connect_async(tcp_opts,
+	[this, cb](error_code const& ec)
+	{
+		if (ec) {
+			cb(ec);
+			return;
+		}
+		stream_.reset(new stream_type(tcp_.take_socket(), cache_->context()));
+		send_ssl_request(cb);
+	}, caches);
+}
+
+void
+ssl_transport::send_ssl_request(connect_callback cb)
+{
+	auto msg = std::make_shared< message >(empty_tag);
+	msg->write(SSL_REQUEST_CODE);
+	auto data_range = msg->buffer();
+	ASIO_NAMESPACE::async_write(stream_->next_layer(),
+		ASIO_NAMESPACE::buffer(&*data_range.first,
+				data_range.second - data_range.first),
+	[this, cb, msg](error_code const& ec, std::size_t)
+	{
+		if (ec) {
+			close();
+			cb(ec);
+			return;
+		}
+		ASIO_NAMESPACE::async_read(stream_->next_layer(),
+				ASIO_NAMESPACE::buffer(&response_, 1),
+		[this, cb](error_code const& ec, std::size_t)
+		{
+			if (ec) {
+				close();
+				cb(ec);
+				return;
+			}
+			if (response_ != 'S') {
+				local_log(logger::WARNING) << "Server " << host()
+						<< " doesn't accept SSL connections";
+				close();
+				cb(ASIO_NAMESPACE::error::operation_not_supported);
+				return;
+			}
+			handshake(cb);
+		});
+	});
+}
+
+void
+ssl_transport::handshake(connect_callback cb)
+{
+	std::string session_key = host();
+	std::string host_name = session_key.substr(0, session_key.find(':'));
+	bool ip = is_ip_address(host_name);
+
+	SSL* ssl = stream_->native_handle();
+	if (!ip)
+		SSL_set_tlsext_host_name(ssl, host_name.c_str());
+	if (cache_->verify()) {
+		X509_VERIFY_PARAM* param = SSL_get0_param(ssl);
+		if (ip) {
+			X509_VERIFY_PARAM_set1_ip_asc(param, host_name.c_str());
+		} else {
+			X509_VERIFY_PARAM_set1_host(param, host_name.c_str(), 0);
+		}
+	}
+	bool resuming = cache_->resume(ssl, session_key);
+
+	stream_ptr stream = stream_;
+	stream->async_handshake(stream_type::client, strand_.wrap(
+	[this, cb, resuming, stream](error_code const& ec)
+	{
+		if (ec) {
+			local_log(logger::WARNING) << "SSL handshake with " << host()
+					<< " failed: " << ec.message();
+			close();
+		} else {
+			session_reused_ = SSL_session_reused(stream->native_handle());
+			local_log() << "SSL connection to " << host()
+					<< (session_reused_ ? " resumed the session" :
+						(resuming ? " failed to resume the session" : ""));
+		}
+		cb(ec);
+	}));
+}
+
+bool
+ssl_transport::connected() const
+{
+	return stream_ && stream_->lowest_layer().is_open();
+}
+
+void
+ssl_transport::close()
+{
+	if (stream_) {
+		// The transport gives up the stream at once, the stream lives until
+		// the shutdown is done on the strand
+		stream_ptr stream = std::move(stream_);
+		strand_.dispatch(
+		[stream]()
+		{
+			// Without a shutdown OpenSSL drops the session as a bad one.
+			// The engine of asio works over memory BIOs, so the shutdown only
+			// marks the session as closed cleanly, the close_notify is not
+			// sent to the server
+			SSL* ssl = stream->native_handle();
+			if (stream->lowest_layer().is_open() && SSL_is_init_finished(ssl))
+				SSL_shutdown(ssl);
+			error_code ec;
+			stream->lowest_layer().close(ec);
+		});
+	}
+	tcp_.close();
+}
+
+}  // namespace detail
+}  // namespace pg
+}  // namespace db
+}  // namespace tip
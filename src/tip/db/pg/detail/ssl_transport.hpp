@@ -0,0 +1,175 @@
+/*
+ * ssl_transport.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_SSL_TRANSPORT_HPP_
+#define TIP_DB_PG_DETAIL_SSL_TRANSPORT_HPP_
+
+#include <tip/db/pg/detail/transport.hpp>
+
+#ifdef WITH_BOOST_ASIO
+#include <boost/asio/ssl.hpp>
+#else
+#include <asio/ssl.hpp>
+#endif
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * TLS context and the last sessions with the hosts, shared by the
+ * connections of a pool. A new connection to a host resumes the session,
+ * so the full handshake is done once per host.
+ */
+class tls_session_cache : private boost::noncopyable {
+public:
+	typedef ASIO_NAMESPACE::ssl::context context_type;
+
+	/**
+	 * Create the client context. With sslrootcert in the options the
+	 * server certificate is verified.
+	 * @throw error::connection_error if the root certificate fails to load
+	 */
+	explicit
+	tls_session_cache(connection_options const&);
+	~tls_session_cache();
+
+	context_type&
+	context()
+	{ return context_; }
+	/** Verify the server certificate and host name */
+	bool
+	verify() const
+	{ return verify_; }
+
+	/**
+	 * Set the session of the host to a connection before the handshake.
+	 * The new sessions of the connection are stored by the host, the
+	 * connection keeps a copy of it.
+	 * @return true if there is a session to resume
+	 */
+	bool
+	resume(SSL*, std::string const& host);
+
+	/** Number of hosts with a session */
+	std::size_t
+	size() const;
+private:
+	static int
+	new_session(SSL*, SSL_SESSION*);
+	void
+	store(std::string const& host, SSL_SESSION*);
+
+	typedef std::mutex mutex_type;
+	typedef std::lock_guard< mutex_type > lock_type;
+	typedef std::map< std::string, SSL_SESSION* > sessions_type;
+
+	context_type context_;
+	bool verify_;
+	mutable mutex_type mutex_;
+	sessions_type sessions_;
+};
+
+/**
+ * TCP transport encrypted with TLS.
+ *
+ * The connection is established by a tcp_transport, then an SSLRequest is
+ * sent and, if the server accepts it, the TLS handshake is done, resuming
+ * the session from the tls_session_cache of the pool when possible.
+ */
+struct ssl_transport {
+	typedef asio_config::io_service_ptr io_service_ptr;
+	typedef asio_config::tcp tcp;
+	typedef asio_config::error_code error_code;
+	typedef std::function< void (error_code const&) > connect_callback;
+	typedef ASIO_NAMESPACE::ssl::stream< tcp::socket > stream_type;
+
+	ssl_transport(io_service_ptr);
+	~ssl_transport();
+
+	void
+	connect_async(connection_options const&, connect_callback,
+			connection_caches const& = connection_caches{});
+
+	bool
+	connected() const;
+
+	/** The host:port connected to */
+	std::string const&
+	host() const
+	{ return tcp_.host(); }
+
+	/**
+	 * Shut down the TLS session and close the socket. The stream is not
+	 * thread safe, so both are done on the strand.
+	 */
+	void
+	close();
+
+	template < typename BufferType, typename HandlerType >
+	void
+	async_read(BufferType& buffer, HandlerType handler)
+	{
+		// The stream is not thread safe, the operations run on the strand.
+		// An operation keeps the stream until it completes
+		stream_ptr stream = stream_;
+		auto wrapped = strand_.wrap(handler);
+		strand_.dispatch(
+		[stream, buffer, wrapped]()
+		{
+			ASIO_NAMESPACE::async_read(*stream, buffer,
+					ASIO_NAMESPACE::transfer_at_least(1), wrapped);
+		});
+	}
+
+	template < typename BufferType, typename HandlerType >
+	void
+	async_write(BufferType const& buffer, HandlerType handler)
+	{
+		stream_ptr stream = stream_;
+		auto wrapped = strand_.wrap(handler);
+		strand_.dispatch(
+		[stream, buffer, wrapped]()
+		{
+			ASIO_NAMESPACE::async_write(*stream, buffer, wrapped);
+		});
+	}
+
+	/** The last handshake resumed a session instead of a full handshake */
+	bool
+	session_reused() const
+	{ return session_reused_; }
+private:
+	typedef std::shared_ptr< tls_session_cache > cache_ptr;
+	typedef std::shared_ptr< stream_type > stream_ptr;
+
+	void
+	send_ssl_request(connect_callback);
+	void
+	handshake(connect_callback);
+
+	io_service_ptr service_;
+	tcp_transport tcp_;
+	ASIO_NAMESPACE::io_service::strand strand_;
+	cache_ptr cache_;
+	stream_ptr stream_;
+	char response_;
+	bool session_reused_;
+};
+
+}  // namespace detail
+}  // namespace pg
+}  // namespace db
+}  // namespace tip
+
+#endif /* TIP_DB_PG_DETAIL_SSL_TRANSPORT_HPP_ */
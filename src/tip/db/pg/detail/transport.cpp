@@ -6,12 +6,22 @@
  */
 
 #include <tip/db/pg/detail/transport.hpp>
+#include <tip/db/pg/detail/resolver_cache.hpp>
 #include <tip/db/pg/error.hpp>
 
 #include <tip/db/pg/log.hpp>
 
 #include <boost/bind.hpp>
 
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
 namespace tip {
 namespace db {
 namespace pg {
@@ -21,13 +31,231 @@ LOCAL_LOGGING_FACILITY_CFG(POSTGRE, config::CONNECTION_LOG);
 
 //****************************************************************************
 // tcp_layer
+namespace {
+
+/**
+ * Delay before starting a connection attempt to the next address,
+ * as recommended by RFC 8305
+ */
+const std::chrono::milliseconds ATTEMPT_DELAY{250};
+
+#if defined(__linux__)
+template < int Name >
+using tcp_int_option = ASIO_NAMESPACE::detail::socket_option::integer< IPPROTO_TCP, Name >;
+#endif
+
+template < typename Socket, typename Option >
+void
+set_socket_option(Socket& socket, Option const& opt, char const* name)
+{
+	asio_config::error_code ec;
+	socket.set_option(opt, ec);
+	if (ec) {
+		local_log(logger::WARNING) << "Failed to set " << name << ": "
+				<< ec.message();
+	}
+}
+
+/**
+ * Order the addresses alternating the address families, starting with
+ * the family of the first address, so an unreachable family doesn't
+ * delay the connection by the attempt delay per address.
+ */
+std::deque< asio_config::tcp::endpoint >
+interleave_families(std::vector< asio_config::tcp::endpoint > const& endpoints)
+{
+	std::deque< asio_config::tcp::endpoint > first, second, result;
+	for (auto const& ep : endpoints) {
+		if (ep.protocol() == endpoints.front().protocol()) {
+			first.push_back(ep);
+		} else {
+			second.push_back(ep);
+		}
+	}
+	while (!first.empty() || !second.empty()) {
+		if (!first.empty()) {
+			result.push_back(first.front());
+			first.pop_front();
+		}
+		if (!second.empty()) {
+			result.push_back(second.front());
+			second.pop_front();
+		}
+	}
+	return result;
+}
+
+}  // namespace
+
+struct tcp_transport::connect_race {
+	typedef tcp::endpoint endpoint_type;
+	typedef std::deque< endpoint_type > endpoints_type;
+	struct host_state {
+		host_state(std::string const& n)
+			: name(n), port("5432"), resolved(false), in_flight(0)
+		{
+			std::string::size_type pos = name.find(":");
+			host = name.substr(0, pos);
+			if (pos != std::string::npos)
+				port = name.substr(pos + 1);
+		}
+
+		/** host:port as listed in the uri */
+		std::string name;
+		std::string host;
+		std::string port;
+		bool resolved;
+		/** Addresses not tried yet */
+		endpoints_type endpoints;
+		/** Connection attempts to the host's addresses in progress */
+		std::size_t in_flight;
+
+		/** Every address of the host was tried and failed */
+		bool
+		failed() const
+		{ return resolved && endpoints.empty() && in_flight == 0; }
+	};
+	struct attempt {
+		attempt(asio_config::io_service& svc, std::size_t h, endpoint_type const& ep)
+			: host(h), endpoint(ep), socket(svc) {}
+
+		std::size_t host;
+		endpoint_type endpoint;
+		socket_type socket;
+	};
+	typedef std::unique_ptr< tcp::resolver > resolver_ptr;
+	typedef std::unique_ptr< attempt > attempt_ptr;
+	typedef std::mutex mutex_type;
+	typedef std::lock_guard< mutex_type > lock_type;
+
+	connect_race(tcp_transport* t, std::vector< std::string > const& h,
+			std::shared_ptr< resolver_cache > const& c, connect_callback cb)
+		: transport(t), hosts(h.begin(), h.end()), cache(c),
+		  timer(*t->service_), callback(cb), in_flight(0), done(false)
+	{
+	}
+
+	//@{
+	/** @name Under the mutex */
+	/**
+	 * Take the next address to connect to. The addresses of a host are
+	 * taken only after the hosts listed before it are resolved, unless
+	 * skip_unresolved is set.
+	 */
+	bool
+	next_endpoint(bool skip_unresolved, std::size_t& host, endpoint_type& ep)
+	{
+		for (std::size_t n = 0; n < hosts.size(); ++n) {
+			host_state& h = hosts[n];
+			if (!h.resolved && !skip_unresolved)
+				return false;
+			if (!h.endpoints.empty()) {
+				host = n;
+				ep = h.endpoints.front();
+				h.endpoints.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+	/** There are hosts being resolved or addresses to try */
+	bool
+	pending() const
+	{
+		for (auto const& h : hosts) {
+			if (!h.resolved || !h.endpoints.empty())
+				return true;
+		}
+		return false;
+	}
+	/** All attempts failed */
+	bool
+	exhausted() const
+	{
+		return in_flight == 0 && !pending();
+	}
+	/** Stop the attempts, the callback must be called outside the mutex */
+	connect_callback
+	finish()
+	{
+		done = true;
+		timer.cancel();
+		for (auto& r : resolvers)
+			r->cancel();
+		for (auto& a : attempts) {
+			if (a->socket.is_open())
+				a->socket.close();
+		}
+		connect_callback cb;
+		cb.swap(callback);
+		return cb;
+	}
+	//@}
+
+	/** Valid only until done */
+	tcp_transport* transport;
+	std::vector< host_state > hosts;
+	std::shared_ptr< resolver_cache > cache;
+	std::vector< resolver_ptr > resolvers;
+	std::vector< attempt_ptr > attempts;
+	asio_config::steady_timer timer;
+	connect_callback callback;
+	std::size_t in_flight;
+	error_code last_error;
+	bool done;
+	mutex_type mutex;
+};
+
 tcp_transport::tcp_transport(io_service_ptr service) :
-		resolver_(*service), socket(*service)
+		service_(service), socket(*service)
 {
 }
 
 void
-tcp_transport::connect_async(connection_options const& conn, connect_callback cb)
+tcp_transport::set_options(socket_type& s, tcp_options const& opts)
+{
+	using socket_base = ASIO_NAMESPACE::socket_base;
+	set_socket_option(s, tcp::no_delay(opts.no_delay), "TCP_NODELAY");
+	set_socket_option(s, socket_base::keep_alive(opts.keepalives), "SO_KEEPALIVE");
+	if (opts.recv_buffer_size > 0) {
+		set_socket_option(s,
+				socket_base::receive_buffer_size(opts.recv_buffer_size), "SO_RCVBUF");
+	}
+	if (opts.send_buffer_size > 0) {
+		set_socket_option(s,
+				socket_base::send_buffer_size(opts.send_buffer_size), "SO_SNDBUF");
+	}
+#if defined(__linux__)
+	if (opts.keepalives) {
+		if (opts.keepalives_idle.count() > 0) {
+			set_socket_option(s, tcp_int_option< TCP_KEEPIDLE >(
+					opts.keepalives_idle.count()), "TCP_KEEPIDLE");
+		}
+		if (opts.keepalives_interval.count() > 0) {
+			set_socket_option(s, tcp_int_option< TCP_KEEPINTVL >(
+					opts.keepalives_interval.count()), "TCP_KEEPINTVL");
+		}
+		if (opts.keepalives_count > 0) {
+			set_socket_option(s, tcp_int_option< TCP_KEEPCNT >(
+					opts.keepalives_count), "TCP_KEEPCNT");
+		}
+	}
+	if (opts.user_timeout.count() > 0) {
+		set_socket_option(s, tcp_int_option< TCP_USER_TIMEOUT >(
+				opts.user_timeout.count()), "TCP_USER_TIMEOUT");
+	}
+#else
+	if (opts.keepalives_idle.count() > 0 || opts.keepalives_interval.count() > 0 ||
+			opts.keepalives_count > 0 || opts.user_timeout.count() > 0) {
+		local_log(logger::WARNING) << "TCP keepalive intervals and user timeout "
+				"are not supported on the platform";
+	}
+#endif
+}
+
+void
+tcp_transport::connect_async(connection_options const& conn, connect_callback cb,
+		connection_caches const& caches)
 {
 	if (conn.uri.empty()) {
 		throw error::connection_error("No connection uri!");
@@ -35,37 +263,150 @@ tcp_transport::connect_async(connection_options const& conn, connect_callback cb
 	if (conn.schema != "tcp") {
 		throw error::connection_error("Wrong connection schema for TCP transport");
 	}
-	std::string host = conn.uri;
-	std::string svc = "5432";
-	std::string::size_type pos = conn.uri.find(":");
-	if (pos != std::string::npos) {
-		host = conn.uri.substr(0, pos);
-		svc = conn.uri.substr(pos + 1);
+	std::vector< std::string > hosts = conn.hosts();
+	if (hosts.empty()) {
+		throw error::connection_error("No connection uri!");
 	}
+	options_ = conn.tcp;
+	start_race(std::make_shared< connect_race >(this, hosts, caches.dns, cb));
+}
 
-	tcp::resolver::query query (host, svc);
-	resolver_.async_resolve(query, boost::bind(&tcp_transport::handle_resolve,
-				this, _1, _2, cb ));
+void
+tcp_transport::start_race(connect_race_ptr race)
+{
+	{
+		connect_race::lock_type lock(race->mutex);
+		for (std::size_t n = 0; n < race->hosts.size(); ++n) {
+			connect_race::host_state& h = race->hosts[n];
+			resolver_cache::endpoints_type cached;
+			if (race->cache && race->cache->find(h.host, h.port, cached)) {
+				h.resolved = true;
+				h.endpoints = interleave_families(cached);
+				continue;
+			}
+			race->resolvers.emplace_back(new tcp::resolver(*race->transport->service_));
+			tcp::resolver::query query(h.host, h.port);
+			race->resolvers.back()->async_resolve(query,
+			[race, n](error_code const& ec, tcp::resolver::iterator endpoints)
+			{
+				handle_resolve(race, n, ec, endpoints);
+			});
+		}
+	}
+	start_attempt(race, false);
+}
 
+void
+tcp_transport::start_attempt(connect_race_ptr race, bool skip_unresolved)
+{
+	connect_race::lock_type lock(race->mutex);
+	if (race->done)
+		return;
+	std::size_t host;
+	connect_race::endpoint_type ep;
+	if (race->next_endpoint(skip_unresolved, host, ep)) {
+		std::size_t n = race->attempts.size();
+		race->attempts.emplace_back(
+				new connect_race::attempt(*race->transport->service_, host, ep));
+		++race->in_flight;
+		++race->hosts[host].in_flight;
+		local_log() << "Connection attempt " << n + 1 << " to "
+				<< race->hosts[host].name << " at " << ep;
+		race->attempts.back()->socket.async_connect(ep,
+		[race, n](error_code const& ec)
+		{
+			handle_connect(race, n, ec);
+		});
+	}
+	if (race->pending()) {
+		race->timer.expires_from_now(ATTEMPT_DELAY);
+		race->timer.async_wait(
+		[race](error_code const& ec)
+		{
+			if (!ec)
+				start_attempt(race, true);
+		});
+	}
 }
 
 void
-tcp_transport::handle_resolve(error_code const& ec,
-			tcp::resolver::iterator endpoint_iterator, connect_callback cb)
-{
-	if (!ec) {
-		ASIO_NAMESPACE::async_connect(socket, endpoint_iterator,
-				boost::bind( &tcp_transport::handle_connect,
-						this, _1, cb));
-	} else {
-		cb(ec);
+tcp_transport::handle_resolve(connect_race_ptr race, std::size_t host,
+		error_code const& ec, tcp::resolver::iterator endpoints)
+{
+	connect_callback cb;
+	error_code result;
+	bool start_next = false;
+	{
+		connect_race::lock_type lock(race->mutex);
+		if (race->done)
+			return;
+		connect_race::host_state& h = race->hosts[host];
+		h.resolved = true;
+		if (ec) {
+			local_log(logger::WARNING) << "Failed to resolve " << h.name << ": "
+					<< ec.message();
+			race->last_error = ec;
+		} else {
+			resolver_cache::endpoints_type resolved(endpoints, tcp::resolver::iterator{});
+			if (race->cache)
+				race->cache->store(h.host, h.port, resolved);
+			h.endpoints = interleave_families(resolved);
+		}
+		if (race->exhausted()) {
+			result = race->last_error ? race->last_error :
+					ASIO_NAMESPACE::error::host_not_found;
+			cb = race->finish();
+		} else {
+			// Otherwise the next attempt is started by the timer
+			start_next = race->in_flight == 0;
+		}
 	}
+	if (start_next)
+		start_attempt(race, false);
+	if (cb)
+		cb(result);
 }
 
 void
-tcp_transport::handle_connect(error_code const& ec, connect_callback cb)
+tcp_transport::handle_connect(connect_race_ptr race, std::size_t n,
+		error_code const& ec)
 {
-	cb(ec);
+	connect_callback cb;
+	bool start_next = false;
+	{
+		connect_race::lock_type lock(race->mutex);
+		if (race->done)
+			return;
+		--race->in_flight;
+		connect_race::attempt& a = *race->attempts[n];
+		connect_race::host_state& h = race->hosts[a.host];
+		--h.in_flight;
+		if (!ec) {
+			local_log() << "Connected to " << h.name << " at " << a.endpoint;
+			race->transport->socket = std::move(a.socket);
+			race->transport->host_ = h.name;
+			set_options(race->transport->socket, race->transport->options_);
+			cb = race->finish();
+		} else {
+			local_log(logger::WARNING) << "Failed to connect to "
+					<< h.name << " at " << a.endpoint << ": " << ec.message();
+			race->last_error = ec;
+			// The server may have moved, resolve the host next time. A single
+			// dead address, e.g. of one family on a dual-stack host, keeps
+			// the entry while the other addresses can still connect.
+			if (race->cache && h.failed())
+				race->cache->invalidate(h.host, h.port);
+			if (race->exhausted()) {
+				cb = race->finish();
+			} else {
+				start_next = true;
+			}
+		}
+	}
+	if (start_next)
+		start_attempt(race, false);
+	if (cb)
+		cb(ec);
 }
 
 bool
@@ -81,6 +422,12 @@ tcp_transport::close()
 		socket.close();
 }
 
+tcp_transport::socket_type
+tcp_transport::take_socket()
+{
+	return std::move(socket);
+}
+
 //----------------------------------------------------------------------------
 // socket_transport implementation
 //----------------------------------------------------------------------------
@@ -91,7 +438,7 @@ socket_transport::socket_transport(io_service_ptr service)
 
 void
 socket_transport::connect_async(connection_options const& conn,
-		connect_callback cb)
+		connect_callback cb, connection_caches const&)
 {
 	using asio_config::stream_protocol;
 	if (conn.schema != "socket") {
@@ -103,6 +450,7 @@ socket_transport::connect_async(connection_options const& conn,
 		local_log(logger::WARNING) << "Socket name is empty. Trying default";
 		uri = "/tmp/.s.PGSQL.5432";
 	}
+	uri_ = uri;
 	socket.async_connect(stream_protocol::endpoint(uri),
 			[cb](error_code const& ec) { cb(ec); });
 }
@@ -10,6 +10,7 @@
 
 #include <tip/db/pg/asio_config.hpp>
 #include <tip/db/pg/common.hpp>
+#include <tip/db/pg/detail/connection_caches.hpp>
 
 namespace tip {
 namespace db {
@@ -25,12 +26,27 @@ struct tcp_transport {
 
 	tcp_transport(io_service_ptr);
 
+	/**
+	 * Connect to the first host of the uri that accepts the connection.
+	 * The hosts are resolved in parallel, or taken from the dns cache of
+	 * the pool. The addresses are tried in the order of the hosts, the
+	 * address families of a host alternating (Happy Eyeballs). The next
+	 * address is tried when the previous one fails or doesn't connect
+	 * within a short delay, so several attempts can run in parallel. The
+	 * first connected address wins.
+	 */
 	void
-	connect_async(connection_options const&, connect_callback);
+	connect_async(connection_options const&, connect_callback,
+			connection_caches const& = connection_caches{});
 
 	bool
 	connected() const;
 
+	/** The host:port connected to */
+	std::string const&
+	host() const
+	{ return host_; }
+
 	void
 	close();
 
@@ -48,17 +64,38 @@ struct tcp_transport {
 	{
 		ASIO_NAMESPACE::async_write(socket, buffer, handler);
 	}
+
+	/**
+	 * Apply the settings to a connected socket. A setting that fails
+	 * or is not supported on the platform is logged and skipped.
+	 */
+	static void
+	set_options(socket_type&, tcp_options const&);
+
+	/**
+	 * Move the connected socket out of the transport, for a transport
+	 * doing the I/O on its own.
+	 */
+	socket_type
+	take_socket();
 private:
-	tcp::resolver resolver_;
+	struct connect_race;
+	using connect_race_ptr = std::shared_ptr< connect_race >;
+
+	static void
+	start_race(connect_race_ptr race);
+	static void
+	start_attempt(connect_race_ptr race, bool skip_unresolved);
+	static void
+	handle_resolve(connect_race_ptr race, std::size_t host, error_code const& ec,
+			tcp::resolver::iterator endpoints);
+	static void
+	handle_connect(connect_race_ptr race, std::size_t n, error_code const& ec);
+
+	io_service_ptr service_;
 	socket_type socket;
-
-
-	void
-	handle_resolve(error_code const& ec,
-					tcp::resolver::iterator endpoint_iterator,
-					connect_callback);
-	void
-	handle_connect(error_code const& ec, connect_callback);
+	std::string host_;
+	tcp_options options_;
 };
 
 struct socket_transport {
@@ -70,11 +107,17 @@ struct socket_transport {
 	socket_transport(io_service_ptr);
 
 	void
-	connect_async(connection_options const&, connect_callback);
+	connect_async(connection_options const&, connect_callback,
+			connection_caches const& = connection_caches{});
 
 	bool
 	connected() const;
 
+	/** The socket file name connected to */
+	std::string const&
+	host() const
+	{ return uri_; }
+
 	void
 	close();
 	template < typename BufferType, typename HandlerType >
@@ -93,6 +136,7 @@ struct socket_transport {
 	}
 private:
 	socket_type socket;
+	std::string uri_;
 };
 
 
@@ -0,0 +1,794 @@
+/*
+ * uring_transport.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <tip/db/pg/detail/uring_transport.hpp>
+
+#include <tip/db/pg/log.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#if defined(__NR_io_uring_setup)
+#define PGASYNC_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+LOCAL_LOGGING_FACILITY_CFG(PGURING, config::CONNECTION_LOG);
+
+#if defined(PGASYNC_HAS_IO_URING)
+
+namespace {
+
+/** Submission queue size, there are at most a receive and a send in flight */
+const unsigned RING_ENTRIES = 8;
+/** Buffers of the multishot receive, a power of two. 512K in flight
+ * keeps a large result streaming without re-arming the receive */
+const unsigned RECV_BUFFERS = 32;
+const std::size_t RECV_BUFFER_SIZE = 16 * 1024;
+const std::uint16_t BUFFER_GROUP = 0;
+
+enum operation : std::uint64_t {
+	RECV_OP = 1,
+	SEND_OP = 2
+};
+
+int
+sys_setup(unsigned entries, io_uring_params* p)
+{
+	return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int
+sys_enter(int fd, unsigned to_submit, unsigned flags)
+{
+	return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, 0,
+			flags, nullptr, 0));
+}
+
+int
+sys_register(int fd, unsigned op, void* arg, unsigned nr)
+{
+	return static_cast<int>(::syscall(__NR_io_uring_register, fd, op, arg, nr));
+}
+
+asio_config::error_code
+system_error(int err)
+{
+	return asio_config::error_code(err, ASIO_NAMESPACE::error::get_system_category());
+}
+
+}  // namespace
+
+/**
+ * A ring of a single connection.
+ *
+ * Submissions are made under the mutex by any thread. The completions
+ * are handled on the strand when the eventfd is signalled, the handlers
+ * are called outside the mutex.
+ */
+class uring_transport::ring : public std::enable_shared_from_this< ring > {
+public:
+	/** A handler to call outside the mutex */
+	struct ready_handler {
+		io_completion cb;
+		error_code ec;
+		std::size_t n;
+	};
+	typedef std::vector< ready_handler > ready_list;
+	typedef std::mutex mutex_type;
+	typedef std::lock_guard< mutex_type > lock_type;
+
+	static ring_ptr
+	create(asio_config::io_service& svc)
+	{
+		ring_ptr r = std::make_shared< ring >(svc);
+		if (!r->setup())
+			return ring_ptr{};
+		return r;
+	}
+
+	ring(asio_config::io_service& svc)
+		: service_(svc), strand_(svc), event_(svc), event_count_(0),
+		  ring_fd_(-1), socket_(-1),
+		  sq_ptr_(nullptr), sq_size_(0), cq_ptr_(nullptr), cq_size_(0),
+		  sqes_(nullptr), sqes_size_(0),
+		  buf_ring_(nullptr), buffers_(nullptr), buf_tail_(0),
+		  multishot_(false), recv_armed_(false),
+		  read_data_(nullptr), read_size_(0), closed_(false)
+	{
+	}
+
+	~ring()
+	{
+		if (socket_ >= 0)
+			::close(socket_);
+		if (ring_fd_ >= 0)
+			::close(ring_fd_);
+		if (sqes_)
+			::munmap(sqes_, sqes_size_);
+		if (cq_ptr_ && cq_ptr_ != sq_ptr_)
+			::munmap(cq_ptr_, cq_size_);
+		if (sq_ptr_)
+			::munmap(sq_ptr_, sq_size_);
+		if (buf_ring_)
+			::munmap(buf_ring_, RECV_BUFFERS * sizeof(io_uring_buf));
+		if (buffers_)
+			::munmap(buffers_, RECV_BUFFERS * RECV_BUFFER_SIZE);
+	}
+
+	/** Take the connected socket and start receiving */
+	void
+	start(int socket)
+	{
+		{
+			lock_type lock(mutex_);
+			socket_ = socket;
+			if (multishot_)
+				arm_recv();
+		}
+		auto self = shared_from_this();
+		strand_.dispatch([self](){ self->wait_events(); });
+	}
+
+	bool
+	open() const
+	{
+		lock_type lock(mutex_);
+		return !closed_;
+	}
+
+	bool
+	multishot() const
+	{
+		lock_type lock(mutex_);
+		return multishot_;
+	}
+
+	void
+	read(void* data, std::size_t size, io_completion&& cb)
+	{
+		lock_type lock(mutex_);
+		if (closed_) {
+			post(cb, ASIO_NAMESPACE::error::operation_aborted, 0);
+			return;
+		}
+		if (!received_.empty() || size == 0) {
+			post(cb, error_code{}, take_received(static_cast<char*>(data), size));
+			return;
+		}
+		if (read_error_) {
+			post(cb, read_error_, 0);
+			return;
+		}
+		read_cb_ = std::move(cb);
+		read_data_ = static_cast<char*>(data);
+		read_size_ = size;
+		if (!multishot_) {
+			io_uring_sqe* sqe = get_sqe();
+			sqe->opcode = IORING_OP_RECV;
+			sqe->fd = socket_;
+			sqe->addr = reinterpret_cast< std::uint64_t >(data);
+			sqe->len = static_cast< std::uint32_t >(size);
+			sqe->user_data = RECV_OP;
+			submit();
+		}
+	}
+
+	void
+	write(const_buffers&& buffers, io_completion&& cb)
+	{
+		lock_type lock(mutex_);
+		if (closed_) {
+			post(cb, ASIO_NAMESPACE::error::operation_aborted, 0);
+			return;
+		}
+		std::size_t total = 0;
+		for (auto const& b : buffers)
+			total += b.size();
+		if (total == 0) {
+			post(cb, error_code{}, 0);
+			return;
+		}
+		writes_.emplace_back();
+		send_op& op = writes_.back();
+		for (auto const& b : buffers) {
+			if (b.size() > 0) {
+				op.iov.push_back(iovec{ const_cast< void* >(b.data()), b.size() });
+			}
+		}
+		op.first = 0;
+		op.written = 0;
+		op.cb = std::move(cb);
+		// Sends are serialized to keep the byte order
+		if (writes_.size() == 1)
+			submit_send();
+	}
+
+	void
+	close()
+	{
+		ready_list ready;
+		{
+			lock_type lock(mutex_);
+			if (closed_)
+				return;
+			closed_ = true;
+			if (read_cb_) {
+				ready.push_back(ready_handler{ std::move(read_cb_),
+						ASIO_NAMESPACE::error::operation_aborted, 0 });
+			}
+			for (auto& op : writes_) {
+				ready.push_back(ready_handler{ std::move(op.cb),
+						ASIO_NAMESPACE::error::operation_aborted, op.written });
+			}
+			writes_.clear();
+			if (socket_ >= 0) {
+				// Wakes up the receive holding a reference to the socket
+				::shutdown(socket_, SHUT_RDWR);
+				::close(socket_);
+				socket_ = -1;
+			}
+		}
+		for (auto& h : ready)
+			h.cb.post(service_, h.ec, h.n);
+		auto self = shared_from_this();
+		strand_.dispatch(
+		[self]()
+		{
+			error_code ec;
+			self->event_.close(ec);
+		});
+	}
+private:
+	struct chunk {
+		std::uint16_t bid;
+		std::size_t offset;
+		std::size_t size;
+	};
+	struct send_op {
+		std::vector< iovec > iov;
+		std::size_t first;
+		std::size_t written;
+		msghdr msg;
+		io_completion cb;
+	};
+
+	bool
+	setup()
+	{
+		io_uring_params p;
+		std::memset(&p, 0, sizeof(p));
+		ring_fd_ = sys_setup(RING_ENTRIES, &p);
+		if (ring_fd_ < 0) {
+			local_log(logger::WARNING) << "io_uring setup failed: "
+					<< std::strerror(errno);
+			return false;
+		}
+		sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+		cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+		bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+		if (single_mmap)
+			sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+		sq_ptr_ = map_ring(sq_size_, IORING_OFF_SQ_RING);
+		if (!sq_ptr_)
+			return false;
+		if (single_mmap) {
+			cq_ptr_ = sq_ptr_;
+		} else if (!(cq_ptr_ = map_ring(cq_size_, IORING_OFF_CQ_RING))) {
+			return false;
+		}
+		sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+		sqes_ = static_cast< io_uring_sqe* >(map_ring(sqes_size_, IORING_OFF_SQES));
+		if (!sqes_)
+			return false;
+
+		char* sq = static_cast< char* >(sq_ptr_);
+		sq_tail_ = reinterpret_cast< unsigned* >(sq + p.sq_off.tail);
+		sq_mask_ = *reinterpret_cast< unsigned* >(sq + p.sq_off.ring_mask);
+		sq_flags_ = reinterpret_cast< unsigned* >(sq + p.sq_off.flags);
+		sq_array_ = reinterpret_cast< unsigned* >(sq + p.sq_off.array);
+		char* cq = static_cast< char* >(cq_ptr_);
+		cq_head_ = reinterpret_cast< unsigned* >(cq + p.cq_off.head);
+		cq_tail_ = reinterpret_cast< unsigned* >(cq + p.cq_off.tail);
+		cq_mask_ = *reinterpret_cast< unsigned* >(cq + p.cq_off.ring_mask);
+		cqes_ = reinterpret_cast< io_uring_cqe* >(cq + p.cq_off.cqes);
+
+		int efd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if (efd < 0) {
+			local_log(logger::WARNING) << "eventfd failed: " << std::strerror(errno);
+			return false;
+		}
+		event_.assign(efd);
+		if (sys_register(ring_fd_, IORING_REGISTER_EVENTFD, &efd, 1) < 0) {
+			local_log(logger::WARNING) << "io_uring eventfd registration failed: "
+					<< std::strerror(errno);
+			return false;
+		}
+		setup_buffers();
+		return true;
+	}
+
+	void*
+	map_ring(std::size_t size, off_t offset)
+	{
+		void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+		if (p == MAP_FAILED) {
+			local_log(logger::WARNING) << "io_uring mmap failed: "
+					<< std::strerror(errno);
+			return nullptr;
+		}
+		return p;
+	}
+
+	/** Register the buffer ring for the multishot receive */
+	void
+	setup_buffers()
+	{
+		void* r = ::mmap(nullptr, RECV_BUFFERS * sizeof(io_uring_buf),
+				PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		void* b = ::mmap(nullptr, RECV_BUFFERS * RECV_BUFFER_SIZE,
+				PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (r == MAP_FAILED || b == MAP_FAILED) {
+			if (r != MAP_FAILED)
+				::munmap(r, RECV_BUFFERS * sizeof(io_uring_buf));
+			if (b != MAP_FAILED)
+				::munmap(b, RECV_BUFFERS * RECV_BUFFER_SIZE);
+			return;
+		}
+		io_uring_buf_reg reg;
+		std::memset(&reg, 0, sizeof(reg));
+		reg.ring_addr = reinterpret_cast< std::uint64_t >(r);
+		reg.ring_entries = RECV_BUFFERS;
+		reg.bgid = BUFFER_GROUP;
+		if (sys_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+			local_log() << "io_uring buffer rings are not supported, "
+					"receive a read at a time";
+			::munmap(r, RECV_BUFFERS * sizeof(io_uring_buf));
+			::munmap(b, RECV_BUFFERS * RECV_BUFFER_SIZE);
+			return;
+		}
+		buf_ring_ = static_cast< io_uring_buf* >(r);
+		buffers_ = static_cast< char* >(b);
+		for (std::uint16_t bid = 0; bid < RECV_BUFFERS; ++bid)
+			provide_buffer(bid);
+		multishot_ = true;
+	}
+
+	void
+	provide_buffer(std::uint16_t bid)
+	{
+		io_uring_buf* buf = &buf_ring_[buf_tail_ & (RECV_BUFFERS - 1)];
+		buf->addr = reinterpret_cast< std::uint64_t >(buffers_ + bid * RECV_BUFFER_SIZE);
+		buf->len = RECV_BUFFER_SIZE;
+		buf->bid = bid;
+		++buf_tail_;
+		// The ring tail overlays the reserved field of the first entry. The
+		// flexible array of io_uring_buf_ring is misplaced when compiled as
+		// C++, so the entries are addressed directly
+		__atomic_store_n(&buf_ring_[0].resv, buf_tail_, __ATOMIC_RELEASE);
+	}
+
+	//@{
+	/** @name Submission, under the mutex */
+	io_uring_sqe*
+	get_sqe()
+	{
+		unsigned idx = *sq_tail_ & sq_mask_;
+		io_uring_sqe* sqe = &sqes_[idx];
+		std::memset(sqe, 0, sizeof(io_uring_sqe));
+		sq_array_[idx] = idx;
+		return sqe;
+	}
+
+	void
+	submit()
+	{
+		__atomic_store_n(sq_tail_, *sq_tail_ + 1, __ATOMIC_RELEASE);
+		int rc;
+		do {
+			rc = sys_enter(ring_fd_, 1, 0);
+		} while (rc < 0 && errno == EINTR);
+		if (rc < 0) {
+			local_log(logger::ERROR) << "io_uring submission failed: "
+					<< std::strerror(errno);
+		}
+	}
+
+	void
+	arm_recv()
+	{
+		io_uring_sqe* sqe = get_sqe();
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = socket_;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = BUFFER_GROUP;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->user_data = RECV_OP;
+		submit();
+		recv_armed_ = true;
+	}
+
+	void
+	submit_send()
+	{
+		send_op& op = writes_.front();
+		std::memset(&op.msg, 0, sizeof(op.msg));
+		op.msg.msg_iov = op.iov.data() + op.first;
+		op.msg.msg_iovlen = op.iov.size() - op.first;
+		io_uring_sqe* sqe = get_sqe();
+		sqe->opcode = IORING_OP_SENDMSG;
+		sqe->fd = socket_;
+		sqe->addr = reinterpret_cast< std::uint64_t >(&op.msg);
+		sqe->len = 1;
+		sqe->msg_flags = MSG_NOSIGNAL;
+		sqe->user_data = SEND_OP;
+		submit();
+	}
+	//@}
+
+	void
+	post(io_completion& cb, error_code const& ec, std::size_t n)
+	{
+		cb.post(service_, ec, n);
+	}
+
+	/** Copy the received data to the read buffer, under the mutex */
+	std::size_t
+	take_received(char* data, std::size_t size)
+	{
+		std::size_t copied = 0;
+		while (!received_.empty() && copied < size) {
+			chunk& c = received_.front();
+			std::size_t n = std::min(c.size, size - copied);
+			std::memcpy(data + copied,
+					buffers_ + c.bid * RECV_BUFFER_SIZE + c.offset, n);
+			c.offset += n;
+			c.size -= n;
+			copied += n;
+			if (c.size == 0) {
+				provide_buffer(c.bid);
+				received_.pop_front();
+			}
+		}
+		if (multishot_ && !recv_armed_ && !read_error_ && !closed_)
+			arm_recv();
+		return copied;
+	}
+
+	/** Complete the pending read with the received data or error */
+	void
+	complete_read(ready_list& ready)
+	{
+		if (!read_cb_)
+			return;
+		if (!received_.empty()) {
+			std::size_t n = take_received(read_data_, read_size_);
+			ready.push_back(ready_handler{ std::move(read_cb_), error_code{}, n });
+		} else if (read_error_) {
+			ready.push_back(ready_handler{ std::move(read_cb_), read_error_, 0 });
+		}
+	}
+
+	//@{
+	/** @name Completion */
+	void
+	wait_events()
+	{
+		auto self = shared_from_this();
+		event_.async_read_some(
+			ASIO_NAMESPACE::buffer(&event_count_, sizeof(event_count_)),
+			strand_.wrap(
+			[self](error_code const& ec, std::size_t)
+			{
+				if (ec)
+					return;
+				self->handle_events();
+				if (self->event_.is_open())
+					self->wait_events();
+			}));
+	}
+
+	void
+	handle_events()
+	{
+		ready_list ready;
+		{
+			lock_type lock(mutex_);
+			for (;;) {
+				unsigned head = *cq_head_;
+				unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+				for (; head != tail; ++head) {
+					io_uring_cqe cqe = cqes_[head & cq_mask_];
+					if (closed_)
+						continue;
+					if (cqe.user_data == RECV_OP) {
+						handle_recv(cqe, ready);
+					} else if (cqe.user_data == SEND_OP) {
+						handle_send(cqe, ready);
+					}
+				}
+				__atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+				// Completions that didn't fit the queue wait in the kernel
+				if (!(__atomic_load_n(sq_flags_, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW))
+					break;
+				sys_enter(ring_fd_, 0, IORING_ENTER_GETEVENTS);
+			}
+		}
+		for (auto& h : ready)
+			h.cb(h.ec, h.n);
+	}
+
+	void
+	handle_recv(io_uring_cqe const& cqe, ready_list& ready)
+	{
+		if (!multishot_) {
+			if (!read_cb_)
+				return;
+			if (cqe.res > 0) {
+				ready.push_back(ready_handler{ std::move(read_cb_), error_code{},
+						static_cast< std::size_t >(cqe.res) });
+			} else if (cqe.res == 0) {
+				ready.push_back(ready_handler{ std::move(read_cb_),
+						ASIO_NAMESPACE::error::eof, 0 });
+			} else {
+				ready.push_back(ready_handler{ std::move(read_cb_),
+						system_error(-cqe.res), 0 });
+			}
+			return;
+		}
+		if (!(cqe.flags & IORING_CQE_F_MORE))
+			recv_armed_ = false;
+		if (cqe.res > 0) {
+			if (cqe.flags & IORING_CQE_F_BUFFER) {
+				std::uint16_t bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+				received_.push_back(chunk{ bid, 0,
+						static_cast< std::size_t >(cqe.res) });
+			}
+			if (!recv_armed_)
+				arm_recv();
+		} else if (cqe.res == 0) {
+			read_error_ = ASIO_NAMESPACE::error::eof;
+		} else if (cqe.res == -ENOBUFS) {
+			// Rearmed when a buffer is consumed
+		} else if (cqe.res == -EINVAL && received_.empty() && !recv_armed_) {
+			local_log() << "Multishot receive is not supported, "
+					"receive a read at a time";
+			multishot_ = false;
+			if (read_cb_) {
+				io_uring_sqe* sqe = get_sqe();
+				sqe->opcode = IORING_OP_RECV;
+				sqe->fd = socket_;
+				sqe->addr = reinterpret_cast< std::uint64_t >(read_data_);
+				sqe->len = static_cast< std::uint32_t >(read_size_);
+				sqe->user_data = RECV_OP;
+				submit();
+			}
+			return;
+		} else {
+			read_error_ = system_error(-cqe.res);
+		}
+		complete_read(ready);
+	}
+
+	void
+	handle_send(io_uring_cqe const& cqe, ready_list& ready)
+	{
+		if (writes_.empty())
+			return;
+		send_op& op = writes_.front();
+		if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+			submit_send();
+			return;
+		}
+		if (cqe.res < 0) {
+			ready.push_back(ready_handler{ std::move(op.cb),
+					system_error(-cqe.res), op.written });
+		} else {
+			std::size_t n = cqe.res;
+			op.written += n;
+			while (op.first < op.iov.size() && n >= op.iov[op.first].iov_len) {
+				n -= op.iov[op.first].iov_len;
+				++op.first;
+			}
+			if (op.first < op.iov.size()) {
+				// Partial send
+				iovec& iov = op.iov[op.first];
+				iov.iov_base = static_cast< char* >(iov.iov_base) + n;
+				iov.iov_len -= n;
+				submit_send();
+				return;
+			}
+			ready.push_back(ready_handler{ std::move(op.cb), error_code{}, op.written });
+		}
+		writes_.pop_front();
+		if (!writes_.empty())
+			submit_send();
+	}
+	//@}
+
+	asio_config::io_service& service_;
+	asio_config::io_service::strand strand_;
+	ASIO_NAMESPACE::posix::stream_descriptor event_;
+	std::uint64_t event_count_;
+
+	int ring_fd_;
+	int socket_;
+
+	//@{
+	/** @name Ring memory */
+	void* sq_ptr_;
+	std::size_t sq_size_;
+	void* cq_ptr_;
+	std::size_t cq_size_;
+	io_uring_sqe* sqes_;
+	std::size_t sqes_size_;
+
+	unsigned* sq_tail_;
+	unsigned sq_mask_;
+	unsigned* sq_flags_;
+	unsigned* sq_array_;
+	unsigned* cq_head_;
+	unsigned* cq_tail_;
+	unsigned cq_mask_;
+	io_uring_cqe* cqes_;
+	//@}
+
+	//@{
+	/** @name Receive buffers */
+	io_uring_buf* buf_ring_;
+	char* buffers_;
+	std::uint16_t buf_tail_;
+	//@}
+
+	bool multishot_;
+	bool recv_armed_;
+	std::deque< chunk > received_;
+	error_code read_error_;
+
+	io_completion read_cb_;
+	char* read_data_;
+	std::size_t read_size_;
+
+	std::deque< send_op > writes_;
+	bool closed_;
+	mutable mutex_type mutex_;
+};
+
+bool
+uring_transport::available()
+{
+	static const bool res = []()
+	{
+		io_uring_params p;
+		std::memset(&p, 0, sizeof(p));
+		int fd = sys_setup(1, &p);
+		if (fd < 0) {
+			local_log(logger::WARNING) << "io_uring is not available: "
+					<< std::strerror(errno);
+			return false;
+		}
+		::close(fd);
+		return true;
+	}();
+	return res;
+}
+
+#else
+
+/** A stub, io_uring is not available on the platform */
+class uring_transport::ring {
+public:
+	static ring_ptr
+	create(asio_config::io_service&)
+	{ return ring_ptr{}; }
+
+	void start(int) {}
+	bool open() const { return false; }
+	bool multishot() const { return false; }
+	void read(void*, std::size_t, io_completion&&) {}
+	void write(const_buffers&&, io_completion&&) {}
+	void close() {}
+};
+
+bool
+uring_transport::available()
+{
+	return false;
+}
+
+#endif /* PGASYNC_HAS_IO_URING */
+
+uring_transport::uring_transport(io_service_ptr service)
+	: service_(service), tcp_(service)
+{
+}
+
+uring_transport::~uring_transport()
+{
+	close();
+}
+
+void
+uring_transport::connect_async(connection_options const& conn, connect_callback cb,
+		connection_caches const& caches)
+{
+	close();
+	ring_.reset();
+	tcp_.connect_async(conn,
+	[this, cb](error_code const& ec)
+	{
+		if (!ec && available()) {
+			ring_ptr r = ring::create(*service_);
+			if (r) {
+				r->start(tcp_.take_socket().release());
+				ring_ = r;
+			} else {
+				local_log(logger::WARNING) << "Failed to create an io_uring, "
+						"use the reactor";
+			}
+		}
+		cb(ec);
+	}, caches);
+}
+
+bool
+uring_transport::connected() const
+{
+	if (ring_)
+		return ring_->open();
+	return tcp_.connected();
+}
+
+void
+uring_transport::close()
+{
+	// The ring is kept, the operations started after close are aborted
+	if (ring_)
+		ring_->close();
+	tcp_.close();
+}
+
+bool
+uring_transport::multishot() const
+{
+	return ring_ && ring_->multishot();
+}
+
+void
+uring_transport::start_read(void* data, std::size_t size, io_completion&& cb)
+{
+	ring_->read(data, size, std::move(cb));
+}
+
+void
+uring_transport::start_write(const_buffers&& buffers, io_completion&& cb)
+{
+	ring_->write(std::move(buffers), std::move(cb));
+}
+
+}  // namespace detail
+}  // namespace pg
+}  // namespace db
+}  // namespace tip
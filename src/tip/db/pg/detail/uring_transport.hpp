@@ -0,0 +1,270 @@
+/*
+ * uring_transport.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef TIP_DB_PG_DETAIL_URING_TRANSPORT_HPP_
+#define TIP_DB_PG_DETAIL_URING_TRANSPORT_HPP_
+
+#include <tip/db/pg/detail/transport.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace detail {
+
+/**
+ * Type-erased read or write handler of the uring_transport.
+ *
+ * The handler is stored in memory from its associated allocator and the
+ * memory is released before the handler is called, so the handler memory
+ * of a connection is reused as with the asio transports.
+ */
+class io_completion {
+public:
+	typedef asio_config::error_code error_code;
+
+	io_completion() : op_(nullptr) {}
+
+	template < typename Handler >
+	explicit
+	io_completion(Handler handler)
+		: op_(op< Handler >::create(std::move(handler))) {}
+
+	io_completion(io_completion&& rhs) : op_(rhs.op_)
+	{ rhs.op_ = nullptr; }
+
+	io_completion&
+	operator = (io_completion&& rhs)
+	{
+		if (this != &rhs) {
+			reset();
+			op_ = rhs.op_;
+			rhs.op_ = nullptr;
+		}
+		return *this;
+	}
+
+	io_completion(io_completion const&) = delete;
+	io_completion&
+	operator = (io_completion const&) = delete;
+
+	~io_completion()
+	{ reset(); }
+
+	explicit
+	operator bool() const
+	{ return op_ != nullptr; }
+
+	/** Call the handler */
+	void
+	operator()(error_code const& ec, std::size_t n)
+	{
+		op_base* o = op_;
+		op_ = nullptr;
+		o->complete_(o, action::invoke, nullptr, ec, n);
+	}
+
+	/** Post the handler with the arguments to the io_service */
+	void
+	post(asio_config::io_service& svc, error_code const& ec, std::size_t n)
+	{
+		op_base* o = op_;
+		op_ = nullptr;
+		o->complete_(o, action::post, &svc, ec, n);
+	}
+private:
+	enum class action { invoke, post, destroy };
+
+	struct op_base {
+		typedef void (*complete_fn)(op_base*, action, asio_config::io_service*,
+				error_code const&, std::size_t);
+		complete_fn complete_;
+	};
+
+	/** The handler bound to the arguments, keeps the allocator */
+	template < typename Handler >
+	struct bound_handler {
+		typedef typename ASIO_NAMESPACE::associated_allocator<
+				Handler >::type allocator_type;
+
+		allocator_type
+		get_allocator() const
+		{ return ASIO_NAMESPACE::get_associated_allocator(handler_); }
+
+		void
+		operator()()
+		{ handler_(ec_, n_); }
+
+		Handler handler_;
+		error_code ec_;
+		std::size_t n_;
+	};
+
+	template < typename Handler >
+	struct op : op_base {
+		typedef typename ASIO_NAMESPACE::associated_allocator<
+				Handler >::type handler_allocator_type;
+		typedef typename std::allocator_traits< handler_allocator_type >::
+				template rebind_alloc< op > allocator_type;
+		typedef std::allocator_traits< allocator_type > alloc_traits;
+
+		explicit
+		op(Handler&& h) : op_base{ &op::do_complete }, handler_(std::move(h)) {}
+
+		static op_base*
+		create(Handler&& h)
+		{
+			allocator_type alloc(ASIO_NAMESPACE::get_associated_allocator(h));
+			op* p = alloc_traits::allocate(alloc, 1);
+			try {
+				alloc_traits::construct(alloc, p, std::move(h));
+			} catch (...) {
+				alloc_traits::deallocate(alloc, p, 1);
+				throw;
+			}
+			return p;
+		}
+
+		static void
+		do_complete(op_base* base, action a, asio_config::io_service* svc,
+				error_code const& ec, std::size_t n)
+		{
+			op* p = static_cast< op* >(base);
+			allocator_type alloc(ASIO_NAMESPACE::get_associated_allocator(p->handler_));
+			Handler handler(std::move(p->handler_));
+			alloc_traits::destroy(alloc, p);
+			alloc_traits::deallocate(alloc, p, 1);
+			switch (a) {
+				case action::invoke:
+					handler(ec, n);
+					break;
+				case action::post:
+					svc->post(bound_handler< Handler >{ std::move(handler), ec, n });
+					break;
+				default:
+					break;
+			}
+		}
+
+		Handler handler_;
+	};
+
+	void
+	reset()
+	{
+		if (op_) {
+			op_base* o = op_;
+			op_ = nullptr;
+			o->complete_(o, action::destroy, nullptr, error_code{}, 0);
+		}
+	}
+
+	op_base* op_;
+};
+
+/**
+ * TCP transport doing the socket I/O through io_uring.
+ *
+ * The connection is established by a tcp_transport, then the socket is
+ * taken from asio. Where the kernel supports it, the data is received by a
+ * multishot receive into a ring of buffers registered with the kernel, so
+ * a stream of rows doesn't cost a syscall per chunk. Older kernels get a
+ * receive request per read. The completions are signalled to the
+ * io_service via an eventfd.
+ *
+ * When io_uring is not available (not Linux, an old kernel, a seccomp
+ * policy) the transport works as a plain tcp_transport.
+ */
+struct uring_transport {
+	typedef asio_config::io_service_ptr io_service_ptr;
+	typedef asio_config::error_code error_code;
+	typedef std::function< void (error_code const&) > connect_callback;
+	typedef std::vector< ASIO_NAMESPACE::const_buffer > const_buffers;
+
+	uring_transport(io_service_ptr);
+	~uring_transport();
+
+	void
+	connect_async(connection_options const&, connect_callback,
+			connection_caches const& = connection_caches{});
+
+	bool
+	connected() const;
+
+	/** The host:port connected to */
+	std::string const&
+	host() const
+	{ return tcp_.host(); }
+
+	void
+	close();
+
+	template < typename BufferType, typename HandlerType >
+	void
+	async_read(BufferType& buffer, HandlerType handler)
+	{
+		if (!ring_) {
+			tcp_.async_read(buffer, handler);
+			return;
+		}
+		auto b = ASIO_NAMESPACE::buffer_sequence_begin(buffer);
+		auto e = ASIO_NAMESPACE::buffer_sequence_end(buffer);
+		ASIO_NAMESPACE::mutable_buffer first;
+		if (b != e)
+			first = *b;
+		start_read(first.data(), first.size(), io_completion{ std::move(handler) });
+	}
+
+	template < typename BufferType, typename HandlerType >
+	void
+	async_write(BufferType const& buffer, HandlerType handler)
+	{
+		if (!ring_) {
+			tcp_.async_write(buffer, handler);
+			return;
+		}
+		const_buffers buffers;
+		for (auto b = ASIO_NAMESPACE::buffer_sequence_begin(buffer);
+				b != ASIO_NAMESPACE::buffer_sequence_end(buffer); ++b) {
+			buffers.push_back(ASIO_NAMESPACE::const_buffer(*b));
+		}
+		start_write(std::move(buffers), io_completion{ std::move(handler) });
+	}
+
+	/** io_uring can be used on the system */
+	static bool
+	available();
+	/** The socket I/O goes through io_uring */
+	bool
+	using_uring() const
+	{ return static_cast<bool>(ring_); }
+	/** The data is received by a multishot receive */
+	bool
+	multishot() const;
+private:
+	class ring;
+	using ring_ptr = std::shared_ptr< ring >;
+
+	void
+	start_read(void* data, std::size_t size, io_completion&&);
+	void
+	start_write(const_buffers&&, io_completion&&);
+
+	io_service_ptr service_;
+	tcp_transport tcp_;
+	ring_ptr ring_;
+};
+
+}  // namespace detail
+}  // namespace pg
+}  // namespace db
+}  // namespace tip
+
+#endif /* TIP_DB_PG_DETAIL_URING_TRANSPORT_HPP_ */
@@ -57,6 +57,17 @@ query_error::query_error(std::string const& message,
 {
 }
 
+query_timeout::query_timeout(std::string const& what_arg)
+	: query_error(what_arg, "ERROR", "57014", "")
+{
+}
+
+query_timeout::query_timeout(std::string const& message,
+		std::string s, std::string c, std::string d)
+	: query_error(message, s, c, d)
+{
+}
+
 client_error::client_error(std::string const& what_arg)
 	: db_error(what_arg)
 {
@@ -0,0 +1,109 @@
+/*
+ * metrics.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <tip/db/pg/metrics.hpp>
+
+#include <iostream>
+
+namespace tip {
+namespace db {
+namespace pg {
+
+constexpr ::std::size_t latency_histogram::bucket_count;
+
+::std::size_t
+latency_histogram::bucket_of(duration val)
+{
+    ::std::size_t bucket = 0;
+    while (bucket < bucket_count - 1 && val >= upper_bound(bucket))
+        ++bucket;
+    return bucket;
+}
+
+latency_histogram::duration
+latency_histogram::quantile(double q) const
+{
+    if (count == 0)
+        return duration::zero();
+    counter_type rank = static_cast<counter_type>(q * count);
+    if (rank >= count)
+        rank = count - 1;
+    counter_type seen = 0;
+    for (::std::size_t i = 0; i < bucket_count - 1; ++i) {
+        seen += buckets[i];
+        if (seen > rank)
+            return upper_bound(i);
+    }
+    return max;
+}
+
+double
+pool_metrics::creation_rate() const
+{
+    if (uptime == duration::zero())
+        return 0;
+    return connections_created * 1000.0 / uptime.count();
+}
+
+::std::ostream&
+operator << (::std::ostream& os, latency_histogram const& val)
+{
+    ::std::ostream::sentry s(os);
+    if (s) {
+        os << "count " << val.count
+            << " sum " << val.sum.count() << "us"
+            << " max " << val.max.count() << "us"
+            << " p50 " << val.quantile(0.5).count() << "us"
+            << " p99 " << val.quantile(0.99).count() << "us";
+    }
+    return os;
+}
+
+::std::ostream&
+operator << (::std::ostream& os, connection_metrics const& val)
+{
+    ::std::ostream::sentry s(os);
+    if (s) {
+        os << "Conn# " << val.number
+            << (val.busy ? " busy" : " idle")
+            << " queries " << val.queries
+            << " errors " << val.errors
+            << " bytes in " << val.bytes_in
+            << " out " << val.bytes_out
+            << " reads " << val.reads
+            << " full " << val.full_reads
+            << " read size " << val.read_size;
+    }
+    return os;
+}
+
+::std::ostream&
+operator << (::std::ostream& os, pool_metrics const& val)
+{
+    ::std::ostream::sentry s(os);
+    if (s) {
+        os << val.alias
+            << " " << val.role << " " << val.uri
+            << " shard " << val.shard
+            << " size " << val.idle + val.busy + val.connecting
+            << "/" << val.max_size
+            << " idle " << val.idle
+            << " busy " << val.busy
+            << " connecting " << val.connecting
+            << " queue " << val.queue_depth
+            << " acquired " << val.acquired
+            << " created " << val.connections_created
+            << " closed " << val.connections_closed
+            << " errors " << val.connection_errors
+            << " acquire wait (" << val.acquire_wait << ")";
+    }
+    return os;
+}
+
+}  // namespace pg
+}  // namespace db
+}  // namespace tip
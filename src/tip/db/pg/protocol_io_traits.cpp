@@ -33,7 +33,7 @@ std::set< oid_type > BINARY_PARSERS {
 }  // namespace
 
 void
-register_parser_type(oids::type::oid_type oid)
+register_binary_parser(oids::type::oid_type oid)
 {
     BINARY_PARSERS.insert(oid);
 }
@@ -102,14 +102,9 @@ protocol_parser< bytea, TEXT_DATA_FORMAT >::operator()(std::istream& in)
 bool
 protocol_parser< bytea, TEXT_DATA_FORMAT >::operator()(buffer_type& buffer)
 {
-    std::vector<byte> data;
-    auto result = detail::bytea_parser().parse(buffer.begin(), buffer.end(),
-            std::back_inserter(data));
-    if (result.first) {
-        base_type::value.swap(data);
-        return true;
-    }
-    return false;
+    if (buffer.empty())
+        return false;
+    return (*this)(buffer.begin(), buffer.end()) != buffer.begin();
 }
 
 using ::boost::posix_time::ptime;
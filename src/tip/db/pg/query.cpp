@@ -29,6 +29,9 @@ struct query::impl : std::enable_shared_from_this<query::impl> {
     type_oid_sequence   param_types_;
     params_buffer       params_;
 
+    transaction_mode::duration  timeout_ = transaction_mode::duration::zero();
+    bool                commit_after_ = false;
+
     impl(dbalias const& alias, transaction_mode const& m,
             std::string const& expression)
         : alias_{alias}, mode_{m}, tran_{}, expression_{expression}
@@ -57,8 +60,9 @@ struct query::impl : std::enable_shared_from_this<query::impl> {
 
     impl(impl const& rhs)
         : enable_shared_from_this(rhs),
-          alias_(rhs.alias_), tran_(), expression_(rhs.expression_),
-          param_types_(rhs.param_types_), params_(rhs.params_)
+          alias_(rhs.alias_), mode_(rhs.mode_), tran_(), expression_(rhs.expression_),
+          param_types_(rhs.param_types_), params_(rhs.params_),
+          timeout_(rhs.timeout_), commit_after_(rhs.commit_after_)
     {
     }
 
@@ -102,7 +106,7 @@ struct query::impl : std::enable_shared_from_this<query::impl> {
                         << expression_
                         << logger::severity_color();
             }
-            tran_->execute(expression_, res, err);
+            tran_->execute(expression_, res, err, timeout_, commit_after_);
         } else {
             {
                 local_log() << "Execute prepared query "
@@ -110,7 +114,8 @@ struct query::impl : std::enable_shared_from_this<query::impl> {
                         << expression_
                         << logger::severity_color();
             }
-            tran_->execute(expression_, param_types_, params_, res, err);
+            tran_->execute(expression_, param_types_, params_, res, err,
+                    timeout_, commit_after_);
         }
         tran_.reset();
     }
@@ -144,6 +149,27 @@ query::bind()
     return *this;
 }
 
+query&
+query::timeout(transaction_mode::duration timeout)
+{
+    pimpl_->timeout_ = timeout;
+    return *this;
+}
+
+query&
+query::autocommit(bool value)
+{
+    pimpl_->mode_.autocommit = value;
+    return *this;
+}
+
+query&
+query::commit_after(bool value)
+{
+    pimpl_->commit_after_ = value;
+    return *this;
+}
+
 void
 query::run_async(query_result_callback const& res, error_callback const& err) const
 {
@@ -12,6 +12,7 @@
 #include <tip/db/pg/log.hpp>
 
 #include <algorithm>
+#include <ostream>
 #include <assert.h>
 
 namespace tip {
@@ -150,6 +151,29 @@ resultset::field::input_buffer() const
 	return result_->at(row_index_, field_index_);
 }
 
+field_view
+resultset::field::view() const
+{
+	return result_->view(row_index_, field_index_);
+}
+
+bool
+resultset::field::to(field_view& val) const
+{
+	val = view();
+	return true;
+}
+
+bool
+resultset::field::to(boost::string_ref& val) const
+{
+	field_view v = view();
+	if (v.is_null())
+		throw error::value_is_null(name());
+	val = v.str();
+	return true;
+}
+
 //----------------------------------------------------------------------------
 // result::const_field_iterator implementation
 //----------------------------------------------------------------------------
@@ -281,16 +305,22 @@ resultset::row_description() const
 resultset::size_type
 resultset::index_of_name(std::string const& name) const
 {
-	row_description_type const& descriptions
-		= pimpl_->row_description();
-	auto f = std::find_if(descriptions.begin(), descriptions.end(),
-			[name](field_description const& fd) {
-				return fd.name == name;
-			});
-	if (f != descriptions.end()) {
-		return f - descriptions.begin();
-	}
-	return npos;
+	usmallint idx = pimpl_->index_of_name(name);
+	if (idx == detail::result_impl::npos)
+		return npos;
+	return idx;
+}
+
+resultset::column_binding
+resultset::bind(std::initializer_list<std::string> const& names) const
+{
+	return column_binding(pimpl_->bind(names));
+}
+
+resultset::column_binding
+resultset::bind(std::vector<std::string> const& names) const
+{
+	return column_binding(pimpl_->bind(names));
 }
 
 field_description const&
@@ -302,11 +332,10 @@ resultset::field(size_type col_index) const
 field_description const&
 resultset::field(std::string const& name) const
 {
-	for (field_description const& fd : pimpl_->row_description()) {
-		if (fd.name == name)
-			return fd;
-	}
-	throw std::runtime_error("No field with name");
+	size_type idx = index_of_name(name);
+	if (idx == npos)
+		throw std::runtime_error("No field with name");
+	return pimpl_->row_description()[idx];
 }
 
 std::string const&
@@ -327,6 +356,35 @@ resultset::is_null(size_type r, row::size_type c) const
 	return pimpl_->is_null(r, c);
 }
 
+field_view
+resultset::view(size_type r, row::size_type c) const
+{
+	detail::row_data::data_buffer_bounds bounds = pimpl_->buffer_bounds(r, c);
+	char const* data = bounds.first == bounds.second ? nullptr : &*bounds.first;
+	return field_view(pimpl_, data, bounds.second - bounds.first,
+			pimpl_->is_null(r, c));
+}
+
+bool
+resultset::field_data(size_type r, row::size_type c,
+		const_data_iterator& begin, const_data_iterator& end) const
+{
+	detail::row_data::data_buffer_bounds bounds = pimpl_->buffer_bounds(r, c);
+	begin = bounds.first;
+	end = bounds.second;
+	return pimpl_->is_null(r, c);
+}
+
+std::ostream&
+operator << (std::ostream& os, field_view const& v)
+{
+	std::ostream::sentry s(os);
+	if (s) {
+		os.write(v.data(), v.size());
+	}
+	return os;
+}
+
 }  // namespace pg
 }  // namespace db
 }  // namespace tip
@@ -10,20 +10,39 @@
 #include <tip/db/pg/detail/basic_connection.hpp>
 #include <tip/db/pg/log.hpp>
 
+#include <atomic>
+
 namespace tip {
 namespace db {
 namespace pg {
 
 LOCAL_LOGGING_FACILITY_CFG(PGTRAN, config::QUERY_LOG);
 
-transaction::transaction(connection_ptr conn)
-    : connection_(conn), finished_(false)
+struct transaction::deadline {
+    asio_config::steady_timer   timer;
+    ::std::atomic<bool>         expired;
+    /** The query or the transaction has finished, nothing to cancel */
+    ::std::atomic<bool>         done;
+    /** Queries running under the transaction deadline */
+    ::std::atomic<int>          running;
+
+    deadline(asio_config::io_service_ptr svc, duration timeout)
+        : timer(*svc), expired(false), done(false), running(0)
+    {
+        timer.expires_from_now(timeout);
+    }
+};
+
+transaction::transaction(connection_ptr conn, bool autocommit)
+    : connection_(conn), finished_(false), autocommit_(autocommit),
+      executed_(false)
 {
 }
 
 transaction::~transaction()
 {
-    if (connection_->in_transaction() && !finished_.test_and_set()) {
+    if (!statement_sent() && connection_->in_transaction() &&
+            !finished_.test_and_set()) {
         local_log(logger::WARNING) << "Transaction object abandoned, rolling back";
         try {
             connection_->rollback();
@@ -47,58 +66,188 @@ transaction::in_transaction() const
     return connection_->in_transaction();
 }
 
+void
+transaction::mark_done()
+{
+    finished_.test_and_set();
+    if (deadline_) {
+        deadline_->done = true;
+        deadline_->timer.cancel();
+    }
+}
+
+void
+transaction::start_deadline(duration timeout)
+{
+    if (timeout == duration::zero())
+        return;
+    deadline_ = ::std::make_shared<deadline>(connection_->io_service(), timeout);
+    ::std::weak_ptr<transaction> weak_this = shared_from_this();
+    deadline_ptr d = deadline_;
+    d->timer.async_wait(
+    [weak_this, d](asio_config::error_code const& ec)
+    {
+        auto _this = weak_this.lock();
+        if (!ec && !d->done && _this && _this->in_transaction()) {
+            local_log(logger::WARNING) << "Transaction deadline expired";
+            d->expired = true;
+            if (d->running > 0) {
+                // The query fails with query_canceled and the transaction
+                // is rolled back on the error, or on the results if the
+                // query finishes before the cancel request arrives
+                _this->connection_->cancel();
+            } else {
+                _this->rollback_async();
+            }
+        }
+    });
+}
+
+transaction::deadline_ptr
+transaction::query_deadline(duration timeout)
+{
+    if (timeout == duration::zero())
+        return deadline_ptr{};
+    deadline_ptr d = ::std::make_shared<deadline>(connection_->io_service(), timeout);
+    ::std::weak_ptr<basic_connection> weak_conn = connection_;
+    d->timer.async_wait(
+    [weak_conn, d](asio_config::error_code const& ec)
+    {
+        if (ec || d->done)
+            return;
+        auto conn = weak_conn.lock();
+        if (conn) {
+            local_log(logger::WARNING) << "Query deadline expired";
+            d->expired = true;
+            conn->cancel();
+        }
+    });
+    return d;
+}
+
 void
 transaction::commit_async(notification_callback cb, error_callback ecb)
 {
+    if (statement_sent()) {
+        // Committed by the server
+        if (cb)
+            cb();
+        return;
+    }
     if (!finished_.test_and_set())
-        connection_->commit(cb);
+        connection_->commit(cb, ecb);
 }
 
 void
 transaction::rollback_async(notification_callback cb, error_callback ecb)
 {
+    if (statement_sent()) {
+        if (ecb)
+            ecb(error::db_error("Cannot roll back an autocommit statement"));
+        return;
+    }
     if (!finished_.test_and_set())
-        connection_->rollback(cb);
+        connection_->rollback(cb, ecb);
+}
+
+bool
+transaction::send_statement(query_error_callback const& error_cb)
+{
+    if (autocommit_ && executed_.exchange(true)) {
+        local_log(logger::ERROR) << "Autocommit transaction runs a single statement";
+        if (error_cb)
+            error_cb(error::transaction_closed{});
+        return false;
+    }
+    return true;
 }
 void
 transaction::execute(std::string const& query, query_result_callback result,
-        query_error_callback error)
+        query_error_callback error, duration timeout, bool commit_after)
 {
+    if (!send_statement(error))
+        return;
+    commit_after = commit_after && !autocommit_;
+    deadline_ptr d = query_deadline(timeout);
+    if (deadline_)
+        ++deadline_->running;
     connection_->execute(events::execute{
         query,
         std::bind(&transaction::handle_results, shared_from_this(),
-                std::placeholders::_1, std::placeholders::_2, result),
+                std::placeholders::_1, std::placeholders::_2, result, d),
         std::bind(&transaction::handle_query_error, shared_from_this(),
-                std::placeholders::_1, error)
+                std::placeholders::_1, error, d),
+        commit_after
     });
+    if (commit_after)
+        commit_async();
 }
 void
 transaction::execute(std::string const& query, type_oid_sequence const& param_types,
         std::vector< byte > params_buffer,
-        query_result_callback result, query_error_callback error)
+        query_result_callback result, query_error_callback error,
+        duration timeout, bool commit_after)
 {
+    if (!send_statement(error))
+        return;
+    commit_after = commit_after && !autocommit_;
+    deadline_ptr d = query_deadline(timeout);
+    if (deadline_)
+        ++deadline_->running;
     connection_->execute(events::execute_prepared{
         query, param_types, params_buffer,
         std::bind(&transaction::handle_results, shared_from_this(),
-                std::placeholders::_1, std::placeholders::_2, result),
+                std::placeholders::_1, std::placeholders::_2, result, d),
         std::bind(&transaction::handle_query_error, shared_from_this(),
-                std::placeholders::_1, error)
+                std::placeholders::_1, error, d),
+        commit_after
     });
+    if (commit_after)
+        commit_async();
 }
 
 void
-transaction::handle_results(resultset r, bool complete, query_result_callback result)
+transaction::handle_results(resultset r, bool complete,
+        query_result_callback result, deadline_ptr d)
 {
+    if (complete && query_finished(d)) {
+        // The transaction deadline expired, but the query was done before
+        // the cancel request reached the server
+        rollback_async();
+    }
     if (result) {
         result(shared_from_this(), r, complete);
     }
 }
 
+bool
+transaction::query_finished(deadline_ptr d)
+{
+    if (d) {
+        d->done = true;
+        d->timer.cancel();
+    }
+    if (deadline_) {
+        --deadline_->running;
+        return deadline_->expired;
+    }
+    return false;
+}
+
 void
-transaction::handle_query_error(error::query_error const& e, query_error_callback error)
+transaction::handle_query_error(error::query_error const& e,
+        query_error_callback error_cb, deadline_ptr d)
 {
-    if (error) {
-        error(e);
+    // The transaction is rolled back by the connection on the error
+    query_finished(d);
+    if (error_cb) {
+        bool expired = (d && d->expired) || (deadline_ && deadline_->expired);
+        if (expired && e.sqlstate == sqlstate::query_canceled) {
+            error_cb(error::query_timeout{ "Query deadline expired: " +
+                    ::std::string{e.what()}, e.severity, e.code, e.detail });
+        } else {
+            error_cb(e);
+        }
     }
 }
 
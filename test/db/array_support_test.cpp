@@ -11,6 +11,7 @@
 #include <tip/db/pg/detail/tokenizer_base.hpp>
 #include <tip/db/pg/io/vector.hpp>
 #include <tip/db/pg/io/array.hpp>
+#include <tip/util/endian.hpp>
 
 #include "db/config.hpp"
 #include "test-environment.hpp"
@@ -239,3 +240,106 @@ TEST(ArraySupport, QuotedDatabaseRoundtrip)
 		EXPECT_EQ(in_v, out_v);
 	}
 }
+
+TEST(ArraySupport, BinaryReadTest)
+{
+	using namespace tip::db::pg;
+	typedef std::vector< byte > buffer_type;
+
+	{
+		std::vector< integer > expected;
+		buffer_type buffer;
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1)); // ndim
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(0)); // no nulls
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(oids::type::int4));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(37)); // count
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1)); // lower bound
+		for (integer i = 0; i < 37; ++i) {
+			expected.push_back(i * 0x01020304 - 100);
+			io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(sizeof(integer)));
+			io::protocol_write< BINARY_DATA_FORMAT >(buffer, expected.back());
+		}
+		std::vector< integer > vals;
+		auto c = io::protocol_read< BINARY_DATA_FORMAT >(buffer.begin(), buffer.end(), vals);
+		EXPECT_EQ(buffer.end(), c);
+		EXPECT_EQ(expected, vals);
+	}
+	{
+		std::vector< bigint > expected;
+		buffer_type buffer;
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(0));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(oids::type::int8));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(9));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		for (bigint i = 0; i < 9; ++i) {
+			expected.push_back(i * 0x0102030405060708LL);
+			io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(sizeof(bigint)));
+			io::protocol_write< BINARY_DATA_FORMAT >(buffer, expected.back());
+		}
+		std::vector< bigint > vals;
+		io::protocol_read< BINARY_DATA_FORMAT >(buffer.begin(), buffer.end(), vals);
+		EXPECT_EQ(expected, vals);
+	}
+	{
+		// Arrays with NULLs cannot be represented
+		buffer_type buffer;
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(oids::type::int2));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(-1));
+		std::vector< smallint > vals;
+		auto c = io::protocol_read< BINARY_DATA_FORMAT >(buffer.begin(), buffer.end(), vals);
+		EXPECT_EQ(buffer.begin(), c);
+	}
+	for (auto elem_oid : { oids::type::float4, oids::type::oid }) {
+		// Same element size, another type
+		buffer_type buffer;
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(0));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(elem_oid));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(1));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(sizeof(integer)));
+		io::protocol_write< BINARY_DATA_FORMAT >(buffer, integer(42));
+		std::vector< integer > vals;
+		auto c = io::protocol_read< BINARY_DATA_FORMAT >(buffer.begin(), buffer.end(), vals);
+		EXPECT_EQ(buffer.begin(), c) << elem_oid;
+		EXPECT_TRUE(vals.empty());
+	}
+}
+
+TEST(ArraySupport, BulkEndianConversion)
+{
+	namespace endian = tip::util::endian;
+	for (size_t n : { 0, 1, 7, 8, 15, 16, 33, 100 }) {
+		std::vector< uint16_t > v16(n);
+		std::vector< uint32_t > v32(n);
+		std::vector< uint64_t > v64(n);
+		for (size_t i = 0; i < n; ++i) {
+			v16[i] = static_cast<uint16_t>(i * 0x0102 + 3);
+			v32[i] = static_cast<uint32_t>(i * 0x01020304 + 5);
+			v64[i] = i * 0x0102030405060708ULL + 7;
+		}
+		std::vector< uint16_t > r16(n);
+		std::vector< uint32_t > r32(n);
+		std::vector< uint64_t > r64(n);
+		endian::native_to_big(v16.data(), r16.data(), n);
+		endian::native_to_big(v32.data(), r32.data(), n);
+		endian::native_to_big(v64.data(), r64.data(), n);
+		for (size_t i = 0; i < n; ++i) {
+			EXPECT_EQ(endian::native_to_big(v16[i]), r16[i]);
+			EXPECT_EQ(endian::native_to_big(v32[i]), r32[i]);
+			EXPECT_EQ(endian::native_to_big(v64[i]), r64[i]);
+		}
+		// In-place back conversion
+		endian::big_to_native(r16.data(), r16.data(), n);
+		endian::big_to_native(r32.data(), r32.data(), n);
+		endian::big_to_native(r64.data(), r64.data(), n);
+		EXPECT_EQ(v16, r16);
+		EXPECT_EQ(v32, r32);
+		EXPECT_EQ(v64, r64);
+	}
+}
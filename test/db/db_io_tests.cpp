@@ -12,6 +12,8 @@
 
 #include <gtest/gtest.h>
 
+#include <list>
+
 using namespace tip::db::pg;
 
 
@@ -118,7 +120,71 @@ INSTANTIATE_TEST_CASE_P(IOTest,
 			"\\xdeadbee",
 			"\\x5c78444g414442454546",
 			"\\",
-			""
+			"\\x0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdeX",
+			"ab\\c",
+			"ab\\400"
+));
+
+class ByteaTextDecodeTest :
+		public ::testing::TestWithParam< std::pair< std::string, std::string > > {
+public:
+	typedef std::pair< std::string, std::string > test_pair;
+};
+
+TEST_P(ByteaTextDecodeTest, Decodes)
+{
+	test_pair curr = GetParam();
+	bytea val { 1, 2, 3 };
+	EXPECT_EQ(curr.first.end(), io::protocol_read< TEXT_DATA_FORMAT >(
+			curr.first.begin(), curr.first.end(), val));
+	EXPECT_EQ(curr.second, std::string(val.begin(), val.end()));
+
+	// Hex format through a non-contiguous iterator
+	if (curr.first.size() > 1 && curr.first[1] == 'x') {
+		std::list< char > in(curr.first.begin(), curr.first.end());
+		bytea list_val;
+		EXPECT_EQ(in.end(), io::protocol_read< TEXT_DATA_FORMAT >(
+				in.begin(), in.end(), list_val));
+		EXPECT_EQ(curr.second, std::string(list_val.begin(), list_val.end()));
+	}
+}
+
+TEST(IOTest, ByteaTextDecodeLong)
+{
+	std::string expected;
+	std::string hex = "\\x";
+	char const* digits = "0123456789abcdef";
+	for (int i = 0; i < 1000; ++i) {
+		unsigned char c = static_cast<unsigned char>(i * 7 + i / 256);
+		expected.push_back(static_cast<char>(c));
+		hex.push_back(i % 3 ? digits[c >> 4] : std::toupper(digits[c >> 4]));
+		hex.push_back(i % 5 ? digits[c & 0xf] : std::toupper(digits[c & 0xf]));
+	}
+	bytea val;
+	EXPECT_EQ(hex.end(), io::protocol_read< TEXT_DATA_FORMAT >(
+			hex.begin(), hex.end(), val));
+	EXPECT_EQ(expected, std::string(val.begin(), val.end()));
+
+	hex[hex.size() - 100] = 'g';
+	EXPECT_EQ(hex.begin(), io::protocol_read< TEXT_DATA_FORMAT >(
+			hex.begin(), hex.end(), val));
+}
+
+INSTANTIATE_TEST_CASE_P(IOTest,
+		ByteaTextDecodeTest,
+		::testing::Values(
+			ByteaTextDecodeTest::test_pair{ "\\xdeadbeef", "\xde\xad\xbe\xef" },
+			ByteaTextDecodeTest::test_pair{ "\\xDEADBEEF", "\xde\xad\xbe\xef" },
+			ByteaTextDecodeTest::test_pair{ "\\x5c784445414442454546", "\\xDEADBEEF" },
+			ByteaTextDecodeTest::test_pair{
+				"\\x000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20",
+				std::string("\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a"
+					"\x0b\x0c\x0d\x0e\x0f\x10\x11\x12\x13\x14\x15\x16\x17"
+					"\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f\x20", 33) },
+			ByteaTextDecodeTest::test_pair{ "", "" },
+			ByteaTextDecodeTest::test_pair{ "abc", "abc" },
+			ByteaTextDecodeTest::test_pair{ "a\\\\b", "a\\b" },
+			ByteaTextDecodeTest::test_pair{ "\\000\\377x\\101", std::string("\0\377xA", 4) }
 ));
 
 class QueryParamsWriteTest : public ::testing::TestWithParam< std::tuple<
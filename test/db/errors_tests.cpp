@@ -336,3 +336,39 @@ TEST(ErrorTest, FailQueryQueue)
     }
 }
 
+
+TEST(ErrorTest, QueryTimeout)
+{
+    error::query_timeout e{"Query deadline expired"};
+    EXPECT_EQ(sqlstate::query_canceled, e.sqlstate);
+
+    if (!test::environment::test_database.empty()) {
+        ASSERT_NO_THROW(db_service::add_connection(test::environment::test_database));
+        connection_options opts = connection_options::parse(test::environment::test_database);
+
+        int timeout_callback = 0;
+        bool query_res_callback = false;
+        ASSERT_NO_THROW(db_service::begin(opts.alias,
+        [&](transaction_ptr tran){
+            query(tran, "select pg_sleep(10)")
+                .timeout(::std::chrono::milliseconds{100})(
+            [&](transaction_ptr, resultset, bool) {
+                query_res_callback = true;
+            },
+            [&](error::db_error const& e) {
+                local_log(logger::DEBUG) << "Query error callback fired: "
+                        << e.what();
+                if (dynamic_cast< error::query_timeout const* >(&e))
+                    ++timeout_callback;
+            });
+        },
+        [&](error::db_error const&){
+            db_service::stop();
+        }));
+
+        ASSERT_NO_THROW(db_service::run());
+
+        EXPECT_FALSE(query_res_callback);
+        EXPECT_EQ(1, timeout_callback);
+    }
+}
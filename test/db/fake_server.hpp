@@ -0,0 +1,132 @@
+/*
+ * fake_server.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#ifndef LIB_PG_ASYNC_TEST_DB_FAKE_SERVER_HPP_
+#define LIB_PG_ASYNC_TEST_DB_FAKE_SERVER_HPP_
+
+#include <tip/db/pg/asio_config.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace tip {
+namespace db {
+namespace pg {
+namespace test {
+
+/** Big-endian 32 bit integer as sent on the wire */
+inline std::string
+be32(std::size_t v)
+{
+    std::string s(4, '\0');
+    for (int i = 0; i < 4; ++i)
+        s[i] = static_cast< char >(v >> (24 - i * 8));
+    return s;
+}
+
+/**
+ * Stand-in server for the protocol tests, no database needed.
+ *
+ * Listens on a loopback port and runs the session function for the
+ * first accepted connection in a separate thread.
+ */
+class fake_server {
+public:
+    using tcp = asio_config::tcp;
+
+    /** Blocking I/O of the protocol messages */
+    class session {
+    public:
+        session(tcp::socket& s) : socket_(s) {}
+
+        std::string
+        read_n(std::size_t n)
+        {
+            std::string buf(n, '\0');
+            ASIO_NAMESPACE::read(socket_, ASIO_NAMESPACE::buffer(&buf[0], n));
+            return buf;
+        }
+
+        std::size_t
+        read_length()
+        {
+            std::string l = read_n(4);
+            return (std::size_t(std::uint8_t(l[0])) << 24) |
+                    (std::size_t(std::uint8_t(l[1])) << 16) |
+                    (std::size_t(std::uint8_t(l[2])) << 8) | std::uint8_t(l[3]);
+        }
+
+        /** Body of a message, the tag is read by the caller */
+        std::string
+        read_body()
+        { return read_n(read_length() - 4); }
+
+        void
+        send(char tag, std::string const& body)
+        {
+            std::string msg = tag + be32(body.size() + 4) + body;
+            ASIO_NAMESPACE::write(socket_, ASIO_NAMESPACE::buffer(msg));
+        }
+
+        /** Read until the client closes the connection */
+        void
+        wait_close()
+        {
+            asio_config::error_code ec;
+            char c;
+            while (!ec)
+                ASIO_NAMESPACE::read(socket_, ASIO_NAMESPACE::buffer(&c, 1), ec);
+        }
+    private:
+        tcp::socket& socket_;
+    };
+    using session_function = std::function< void(session&) >;
+
+    explicit
+    fake_server(session_function f)
+        : acceptor_(service_, tcp::endpoint(
+                ASIO_NAMESPACE::ip::address_v4::loopback(), 0))
+    {
+        thread_ = std::thread([this, f]()
+        {
+            tcp::socket s(service_);
+            acceptor_.accept(s);
+            session sess(s);
+            f(sess);
+        });
+    }
+
+    ~fake_server()
+    {
+        join();
+    }
+
+    unsigned short
+    port() const
+    { return acceptor_.local_endpoint().port(); }
+
+    /** Wait for the session to finish */
+    void
+    join()
+    {
+        if (thread_.joinable())
+            thread_.join();
+    }
+private:
+    asio_config::io_service service_;
+    tcp::acceptor           acceptor_;
+    std::thread             thread_;
+};
+
+} /* namespace test */
+} /* namespace pg */
+} /* namespace db */
+} /* namespace tip */
+
+#endif /* LIB_PG_ASYNC_TEST_DB_FAKE_SERVER_HPP_ */
@@ -34,7 +34,8 @@ struct dummy_transport {
     dummy_transport(io_service_ptr) {}
 
     void
-    connect_async(connection_options const&, connect_callback cb)
+    connect_async(connection_options const&, connect_callback cb,
+            connection_caches const&)
     {
         asio_config::error_code ec;
         cb(ec);
@@ -14,6 +14,7 @@
 #include <iostream>
 #include <fstream>
 #include <thread>
+#include <future>
 
 #include "db/config.hpp"
 #include "test-environment.hpp"
@@ -305,3 +306,318 @@ TEST(QueryTest, BasicResultParsing)
         }
     }
 }
+
+TEST(QueryTest, PoolMetrics)
+{
+    using namespace tip::db::pg;
+    char const* conn_str = "pool_metrics_test=tcp://user@localhost:5432[db]";
+    EXPECT_THROW(db_service::metrics("pool_metrics_test"_db), error::connection_error);
+    ASSERT_NO_THROW(db_service::add_connection(conn_str, pool_options{4, 0}));
+    pool_metrics m;
+    ASSERT_NO_THROW(m = db_service::metrics("pool_metrics_test"_db));
+    EXPECT_EQ("pool_metrics_test", m.alias);
+    EXPECT_EQ(4u, m.max_size);
+    EXPECT_EQ(0u, m.idle + m.busy + m.connecting);
+    EXPECT_EQ(0u, m.queue_depth);
+    EXPECT_EQ(0u, m.connections_created);
+    EXPECT_TRUE(m.connections.empty());
+    EXPECT_EQ(1u, db_service::metrics().size());
+    db_service::stop();
+}
+
+TEST(QueryTest, ReplicaRouting)
+{
+    using namespace tip::db::pg;
+    dbalias alias = "replica_routing_test"_db;
+    ASSERT_NO_THROW(db_service::add_connection(
+            "replica_routing_test=tcp://user@replica1:5432[db]?role=replica",
+            pool_options{2, 0}));
+    ASSERT_NO_THROW(db_service::add_connection(
+            "replica_routing_test=tcp://user@replica2:5432[db]?role=replica",
+            pool_options{2, 0}));
+    // No primary registered yet
+    EXPECT_THROW(db_service::begin(alias, [](transaction_ptr){},
+            [](error::db_error const&){}), error::connection_error);
+    ASSERT_NO_THROW(db_service::add_connection(
+            "replica_routing_test=tcp://user@primary:5432[db]",
+            pool_options{2, 0}));
+    EXPECT_EQ(3u, db_service::metrics().size());
+    EXPECT_EQ(host_role::primary, db_service::metrics(alias).role);
+
+    // The service is not running, the requests stay in the queues
+    transaction_mode ro{isolation_level::read_committed, true};
+    for (int i = 0; i < 4; ++i) {
+        db_service::begin(alias, [](transaction_ptr){},
+                [](error::db_error const&){}, ro);
+    }
+    db_service::begin(alias, [](transaction_ptr){},
+            [](error::db_error const&){});
+
+    for (auto const& m : db_service::metrics()) {
+        if (m.role == host_role::primary) {
+            EXPECT_EQ(1u, m.queue_depth) << m;
+        } else {
+            EXPECT_EQ(2u, m.queue_depth) << m;
+        }
+    }
+    db_service::stop();
+}
+
+TEST(QueryTest, Autocommit)
+{
+    using namespace tip::db::pg;
+    if (!test::environment::test_database.empty()) {
+        ASIO_NAMESPACE::deadline_timer timer(*db_service::io_service(),
+                boost::posix_time::seconds(test::environment::deadline));
+        timer.async_wait([&](asio_config::error_code const& ec){
+            if (!ec) {
+                db_service::stop();
+            }
+        });
+
+        connection_options opts = connection_options::parse(test::environment::test_database);
+        opts.alias = "autocommit_test"_db;
+        ASSERT_NO_THROW(db_service::add_connection(opts, pool_options{1}));
+
+        // A single connection, the statements don't commit, so it must
+        // return to the pool by itself
+        const int statements = 3;
+        int results = 0;
+        for (int i = 0; i < statements; ++i) {
+            query(opts.alias, "select 1").autocommit()(
+            [&](transaction_ptr tran, resultset r, bool) {
+                EXPECT_TRUE(tran->autocommit());
+                EXPECT_EQ(1, r.size());
+                // A second statement is not allowed
+                tran->execute("select 2", query_result_callback{},
+                [](error::query_error const& e){
+                    EXPECT_NE(nullptr, dynamic_cast< error::transaction_closed const* >(&e));
+                });
+                if (++results == statements) {
+                    timer.cancel();
+                    EXPECT_EQ(statements, db_service::metrics(opts.alias).acquired);
+                    db_service::stop();
+                }
+            }, [](error::db_error const&){
+                FAIL();
+            });
+        }
+        db_service::run();
+        EXPECT_EQ(statements, results);
+    }
+}
+
+TEST(QueryTest, CommitAfter)
+{
+    using namespace tip::db::pg;
+    if (!test::environment::test_database.empty()) {
+        ASIO_NAMESPACE::deadline_timer timer(*db_service::io_service(),
+                boost::posix_time::seconds(test::environment::deadline));
+        timer.async_wait([&](asio_config::error_code const& ec){
+            if (!ec) {
+                db_service::stop();
+            }
+        });
+
+        connection_options opts = connection_options::parse(test::environment::test_database);
+        opts.alias = "commit_after_test"_db;
+        ASSERT_NO_THROW(db_service::add_connection(opts, pool_options{1}));
+
+        // A single connection, the transactions are committed by the
+        // pipelined COMMIT, so it must return to the pool by itself
+        const int statements = 3;
+        int results = 0;
+        for (int i = 0; i < statements; ++i) {
+            query(opts.alias, "select 1").commit_after()(
+            [&](transaction_ptr, resultset r, bool) {
+                EXPECT_EQ(1, r.size());
+                if (++results == statements) {
+                    timer.cancel();
+                    EXPECT_EQ(statements, db_service::metrics(opts.alias).acquired);
+                    db_service::stop();
+                }
+            }, [](error::db_error const&){
+                FAIL();
+            });
+        }
+        db_service::run();
+        EXPECT_EQ(statements, results);
+    }
+}
+
+TEST(QueryTest, RetryPolicy)
+{
+    using namespace tip::db::pg;
+    using ms = retry_policy::duration;
+    retry_policy policy{ 4, ms{10}, ms{50} };
+    EXPECT_TRUE(policy.retryable(
+            error::query_error{"", "ERROR", "40001", ""}));
+    EXPECT_TRUE(policy.retryable(
+            error::query_error{"", "ERROR", "40P01", ""}));
+    EXPECT_FALSE(policy.retryable(
+            error::query_error{"", "ERROR", "23505", ""}));
+    EXPECT_FALSE(policy.retryable(error::connection_error{"Down"}));
+
+    EXPECT_EQ(ms{10}, policy.delay_bound(1));
+    EXPECT_EQ(ms{20}, policy.delay_bound(2));
+    EXPECT_EQ(ms{40}, policy.delay_bound(3));
+    EXPECT_EQ(ms{50}, policy.delay_bound(4));
+    EXPECT_EQ(ms{50}, policy.delay_bound(100));
+}
+
+TEST(QueryTest, RunTransaction)
+{
+    using namespace tip::db::pg;
+    if (!test::environment::test_database.empty()) {
+        ASIO_NAMESPACE::deadline_timer timer(*db_service::io_service(),
+                boost::posix_time::seconds(test::environment::deadline));
+        timer.async_wait([&](asio_config::error_code const& ec){
+            if (!ec) {
+                db_service::stop();
+            }
+        });
+
+        connection_options opts = connection_options::parse(test::environment::test_database);
+        opts.alias = "retry_test"_db;
+        ASSERT_NO_THROW(db_service::add_connection(opts, pool_options{1}));
+
+        // The first two attempts fail with a serialization failure
+        const int failures = 2;
+        int attempts = 0;
+        bool committed = false;
+        db_service::run_transaction(opts.alias,
+            transaction_mode{ isolation_level::serializable },
+            [&](transaction_ptr tran)
+            {
+                if (attempts++ < failures) {
+                    tran->execute("do $$ begin raise exception "
+                            "'Simulated failure' using errcode = '40001'; end $$",
+                            query_result_callback{},
+                            [](error::query_error const& e){
+                                EXPECT_EQ(sqlstate::serialization_failure, e.sqlstate);
+                            });
+                } else {
+                    tran->execute("select 1", query_result_callback{},
+                            query_error_callback{});
+                }
+                tran->commit_async();
+            },
+            [&]()
+            {
+                committed = true;
+                timer.cancel();
+                db_service::stop();
+            },
+            [&](error::db_error const& e)
+            {
+                FAIL() << e.what();
+            });
+        db_service::run();
+        EXPECT_TRUE(committed);
+        EXPECT_EQ(failures + 1, attempts);
+    }
+}
+
+TEST(QueryTest, Shards)
+{
+    using namespace tip::db::pg;
+    const size_t shards = 3;
+    // Start from a fresh service, the shard count cannot change after
+    // connections are registered by the other tests
+    db_service::stop();
+    ASSERT_NO_THROW(db_service::initialize(pool_options{1}, {}, shards));
+    EXPECT_EQ(shards, db_service::shard_count());
+    EXPECT_FALSE(db_service::current_shard().is_initialized());
+    EXPECT_THROW(db_service::io_service(shards), error::db_error);
+
+    std::vector< size_t > visited(shards, shards);
+    std::vector< std::thread::id > threads(shards);
+    for (size_t n = 0; n < shards; ++n) {
+        db_service::post(n, [n, &visited, &threads](){
+            auto current = db_service::current_shard();
+            ASSERT_TRUE(current.is_initialized());
+            visited[n] = *current;
+            threads[n] = std::this_thread::get_id();
+        });
+    }
+    // The shards run out of work and the run returns
+    db_service::run();
+    for (size_t n = 0; n < shards; ++n) {
+        EXPECT_EQ(n, visited[n]);
+        for (size_t m = 0; m < n; ++m) {
+            EXPECT_NE(threads[m], threads[n]);
+        }
+    }
+    db_service::stop();
+}
+
+TEST(QueryTest, ServiceRunner)
+{
+    using namespace tip::db::pg;
+    runner_options opts{2, true};
+    opts.lag_probe_interval = runner_options::duration{2};
+    ASSERT_NO_THROW(db_service::start(opts));
+    EXPECT_THROW(db_service::start(opts), error::db_error);
+
+    std::promise< std::thread::id > ran;
+    db_service::io_service()->post([&ran](){
+        ran.set_value(std::this_thread::get_id());
+    });
+    auto future = ran.get_future();
+    ASSERT_EQ(std::future_status::ready,
+            future.wait_for(std::chrono::seconds(1)));
+    EXPECT_NE(std::this_thread::get_id(), future.get());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto lag = db_service::event_loop_lag();
+    ASSERT_EQ(1u, lag.size());
+    EXPECT_LT(0u, lag.front().count);
+    // Waits for the threads
+    db_service::stop();
+}
+
+TEST(QueryTest, ShardedServiceRunner)
+{
+    using namespace tip::db::pg;
+    const size_t shards = 2;
+    // Start from a fresh service, the shard count cannot change after
+    // connections are registered by the other tests
+    db_service::stop();
+    ASSERT_NO_THROW(db_service::initialize(pool_options{1}, {}, shards));
+    db_service::start();
+
+    std::vector< std::promise< size_t > > visited(shards);
+    for (size_t n = 0; n < shards; ++n) {
+        db_service::post(n, [n, &visited](){
+            visited[n].set_value(*db_service::current_shard());
+        });
+    }
+    for (size_t n = 0; n < shards; ++n) {
+        auto future = visited[n].get_future();
+        ASSERT_EQ(std::future_status::ready,
+                future.wait_for(std::chrono::seconds(1)));
+        EXPECT_EQ(n, future.get());
+    }
+    EXPECT_EQ(shards, db_service::event_loop_lag().size());
+    db_service::stop();
+}
+
+TEST(QueryTest, LatencyHistogram)
+{
+    using namespace tip::db::pg;
+    using us = latency_histogram::duration;
+    EXPECT_EQ(0u, latency_histogram::bucket_of(us{0}));
+    EXPECT_EQ(1u, latency_histogram::bucket_of(us{1}));
+    EXPECT_EQ(2u, latency_histogram::bucket_of(us{3}));
+    EXPECT_EQ(11u, latency_histogram::bucket_of(us{1024}));
+    EXPECT_EQ(latency_histogram::bucket_count - 1,
+            latency_histogram::bucket_of(::std::chrono::hours{1}));
+
+    latency_histogram h;
+    for (auto v : { 1, 1, 2, 100 }) {
+        ++h.buckets[latency_histogram::bucket_of(us{v})];
+        ++h.count;
+    }
+    EXPECT_EQ(us{4}, h.quantile(0.5));
+    EXPECT_EQ(us{128}, h.quantile(0.99));
+}
@@ -0,0 +1,183 @@
+/*
+ * resultset_tests.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: zmij
+ */
+
+#include <tip/db/pg/resultset.hpp>
+#include <tip/db/pg/resultset.inl>
+#include <tip/db/pg/detail/result_impl.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace tip::db::pg;
+
+namespace {
+
+typedef std::vector< std::string > column_names;
+typedef std::vector< const char* > row_values;
+
+field_description
+make_field(std::string const& name, oids::type::oid_type type)
+{
+	field_description fd;
+	fd.name = name;
+	fd.table_oid = 0;
+	fd.attribute_number = 0;
+	fd.type_oid = type;
+	fd.type_size = -1;
+	fd.type_mod = 0;
+	fd.format_code = TEXT_DATA_FORMAT;
+	fd.max_size = 0;
+	return fd;
+}
+
+/**
+ * Build a text-format result set, nullptr values are nulls
+ */
+resultset
+make_resultset(column_names const& names, std::vector< row_values > const& rows)
+{
+	std::shared_ptr< detail::result_impl > impl(new detail::result_impl);
+	for (auto const& name : names) {
+		impl->row_description().push_back(make_field(name, oids::type::text));
+	}
+	for (auto const& values : rows) {
+		detail::row_data rd;
+		for (detail::row_data::size_type i = 0; i < values.size(); ++i) {
+			rd.offsets.push_back(rd.data.size());
+			if (values[i]) {
+				std::string v(values[i]);
+				rd.data.insert(rd.data.end(), v.begin(), v.end());
+			} else {
+				rd.null_map.insert(i);
+			}
+		}
+		impl->rows().push_back(std::move(rd));
+	}
+	return resultset(impl);
+}
+
+}  // namespace
+
+TEST(ResultsetTest, FieldView)
+{
+	field_view kept;
+	{
+		resultset res = make_resultset({ "key", "value" },
+				{ { "foo", "one" }, { "bar", nullptr }, { "", "three" } });
+		ASSERT_EQ(3, res.size());
+
+		field_view v = res[0][0].view();
+		EXPECT_FALSE(v.is_null());
+		EXPECT_EQ(3, v.size());
+		EXPECT_EQ("foo", v);
+		EXPECT_EQ(std::string("foo"), v.to_string());
+		EXPECT_TRUE(res[0][0].as< field_view >() == res[0][0].view());
+
+		EXPECT_TRUE(res[1][1].view().is_null());
+		EXPECT_TRUE(res[1][1].view().empty());
+		EXPECT_THROW(res[1][1].as< boost::string_ref >(), error::value_is_null);
+
+		EXPECT_FALSE(res[2][0].view().is_null());
+		EXPECT_TRUE(res[2][0].view().empty());
+		EXPECT_EQ("three", res[2]["value"].as< boost::string_ref >());
+
+		std::unordered_set< field_view > keys;
+		for (resultset::row const& row : res) {
+			keys.insert(row[0].view());
+		}
+		EXPECT_EQ(3, keys.size());
+		kept = res[1][0].view();
+	}
+	// The view keeps the result data alive
+	EXPECT_EQ("bar", kept);
+}
+
+TEST(ResultsetTest, ColumnBinding)
+{
+	resultset res = make_resultset({ "a", "b", "c", "a" },
+			{ { "1", "foo", "x", "2" }, { "3", "bar", "y", "4" } });
+	EXPECT_EQ(0, res.index_of_name("a"));
+	EXPECT_EQ(2, res.index_of_name("c"));
+	EXPECT_EQ(resultset::npos, res.index_of_name("d"));
+	EXPECT_EQ("c", res.field("c").name);
+
+	resultset::column_binding cols = res.bind({ "c", "a", "b" });
+	ASSERT_EQ(3, cols.size());
+	EXPECT_EQ(2, cols[0]);
+	EXPECT_EQ(0, cols[1]);
+	EXPECT_EQ(1, cols[2]);
+	EXPECT_EQ(2, res.bind(std::vector< std::string >{ "c", "a", "b" })[0]);
+	EXPECT_EQ(2, res.bind({ "c", "a" }).size());
+	EXPECT_THROW(res.bind({ "a", "d" }), error::db_error);
+
+	std::string c, b;
+	int a;
+	res[1].to(cols, c, a, b);
+	EXPECT_EQ("y", c);
+	EXPECT_EQ(3, a);
+	EXPECT_EQ("bar", b);
+
+	std::tuple< std::string, int > t;
+	res[0].to(cols, t);
+	EXPECT_EQ("x", std::get<0>(t));
+	EXPECT_EQ(1, std::get<1>(t));
+
+	res[0].to({ "b", "a" }, b, a);
+	EXPECT_EQ("foo", b);
+	EXPECT_EQ(1, a);
+	EXPECT_THROW(res[0].to({ "b", "d" }, b, a), error::db_error);
+
+	// More distinct name lists than the cache holds, earlier bindings
+	// keep working
+	std::vector< std::string > names;
+	for (std::size_t i = 0; i < 2 * detail::result_impl::max_cached_bindings; ++i) {
+		names.push_back(i % 2 ? "b" : "c");
+		EXPECT_EQ(names.size(), res.bind(names).size());
+	}
+	res[0].to(cols, c, a, b);
+	EXPECT_EQ("x", c);
+	EXPECT_EQ(1, a);
+	EXPECT_EQ("foo", b);
+}
+
+TEST(ResultsetTest, TypedRange)
+{
+	resultset res = make_resultset({ "id", "name", "flag" },
+			{ { "1", "foo", "t" }, { "2", nullptr, "f" }, { "3", "baz", nullptr } });
+
+	typedef std::tuple< int, boost::optional< std::string > > row_type;
+	std::vector< row_type > rows;
+	for (auto const& t : res.as< int, boost::optional< std::string > >()) {
+		rows.push_back(t);
+	}
+	ASSERT_EQ(3, rows.size());
+	EXPECT_EQ(1, std::get<0>(rows[0]));
+	EXPECT_EQ(std::string("foo"), *std::get<1>(rows[0]));
+	EXPECT_EQ(2, std::get<0>(rows[1]));
+	EXPECT_FALSE(std::get<1>(rows[1]).is_initialized());
+	EXPECT_EQ(3, std::get<0>(rows[2]));
+
+	auto range = res.as< int, std::string, bool >();
+	EXPECT_EQ(3, range.size());
+	EXPECT_TRUE(std::get<2>(range[0]));
+	EXPECT_THROW(range[1], error::value_is_null);
+	EXPECT_THROW(range[2], error::value_is_null);
+
+	EXPECT_THROW((res.as< int, int, int, int >()), error::db_error);
+	EXPECT_TRUE(resultset().as< int >().empty());
+
+	auto by_name = res.as< std::string, int >({ "flag", "id" });
+	EXPECT_EQ("t", std::get<0>(by_name[0]));
+	EXPECT_EQ(2, std::get<1>(by_name[1]));
+	auto bound = res.as< int >(res.bind({ "id" }));
+	EXPECT_EQ(3, std::get<0>(bound[2]));
+	EXPECT_THROW((res.as< int, int >({ "id" })), error::db_error);
+}